@@ -78,6 +78,8 @@ void AbstractBackend::updateCursorFromServer()
     }
     m_cursor.hotspot = c->hotspot();
     m_cursor.image = buffer->data().copy();
+    m_cursor.fromTheme = false;
+    m_cursor.requestedShape = -1;
     emit cursorChanged();
 }
 
@@ -91,11 +93,25 @@ void AbstractBackend::installCursorImage(Qt::CursorShape shape)
 
 void AbstractBackend::updateCursorImage(Qt::CursorShape shape)
 {
+    m_cursor.requestedShape = shape;
+    auto it = m_themeCursors.constFind(shape);
+    if (it != m_themeCursors.constEnd()) {
+        // shape got installed before, no need for a round trip through the internal connection
+        if (m_softWareCursor) {
+            triggerCursorRepaint();
+        }
+        m_cursor.hotspot = it.value().hotspot;
+        m_cursor.image = it.value().image;
+        m_cursor.fromTheme = true;
+        emit cursorChanged();
+        return;
+    }
 #if HAVE_WAYLAND_CURSOR
     if (!m_cursorTheme) {
         // check whether we can create it
         if (waylandServer() && waylandServer()->internalShmPool()) {
             m_cursorTheme = new WaylandCursorTheme(waylandServer()->internalShmPool(), this);
+            connect(Cursor::self(), &Cursor::themeChanged, this, [this] { m_themeCursors.clear(); });
         }
     }
     if (!m_cursorTheme) {
@@ -114,23 +130,29 @@ void AbstractBackend::updateCursorImage(Qt::CursorShape shape)
                               "installThemeCursor",
                               Qt::QueuedConnection,
                               Q_ARG(quint32, KWayland::Client::Buffer::getId(b)),
-                              Q_ARG(QPoint, QPoint(cursor->hotspot_x, cursor->hotspot_y)));
-#else
-    Q_UNUSED(shape)
+                              Q_ARG(QPoint, QPoint(cursor->hotspot_x, cursor->hotspot_y)),
+                              Q_ARG(int, int(shape)));
 #endif
 }
 
-void AbstractBackend::installThemeCursor(quint32 id, const QPoint &hotspot)
+void AbstractBackend::installThemeCursor(quint32 id, const QPoint &hotspot, int shape)
 {
     auto buffer = KWayland::Server::BufferInterface::get(waylandServer()->internalConnection()->getResource(id));
     if (!buffer) {
         return;
     }
+    const QImage image = buffer->data().copy();
+    m_themeCursors.insert(shape, ThemeCursor{image, hotspot});
+    if (m_cursor.requestedShape != shape) {
+        // another cursor got installed in the meantime
+        return;
+    }
     if (m_softWareCursor) {
         triggerCursorRepaint();
     }
     m_cursor.hotspot = hotspot;
-    m_cursor.image = buffer->data().copy();
+    m_cursor.image = image;
+    m_cursor.fromTheme = true;
     emit cursorChanged();
 }
 
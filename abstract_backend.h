@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef KWIN_ABSTRACT_BACKEND_H
 #define KWIN_ABSTRACT_BACKEND_H
 #include <kwin_export.h>
+#include <QHash>
 #include <QImage>
 #include <QObject>
 
@@ -53,6 +54,14 @@ public:
     QPoint softwareCursorHotspot() const {
         return m_cursor.hotspot;
     }
+    /**
+     * Whether the current cursor image is a shape of the cursor theme. Such an image is cached
+     * and reused for the next request of the same shape, so backends can cache what they derive
+     * from it by the image's cacheKey.
+     **/
+    bool isThemeCursor() const {
+        return m_cursor.fromTheme;
+    }
     void markCursorAsRendered();
 
     bool handlesOutputs() const {
@@ -107,7 +116,7 @@ protected:
     }
 
 private Q_SLOTS:
-    void installThemeCursor(quint32 id, const QPoint &hotspot);
+    void installThemeCursor(quint32 id, const QPoint &hotspot, int shape);
 
 private:
     void triggerCursorRepaint();
@@ -116,8 +125,17 @@ private:
         QPoint hotspot;
         QImage image;
         QPoint lastRenderedPosition;
+        bool fromTheme = false;
+        // the last requested theme shape, -1 if a client set the cursor afterwards
+        int requestedShape = -1;
     } m_cursor;
     WaylandCursorTheme *m_cursorTheme = nullptr;
+    struct ThemeCursor {
+        QImage image;
+        QPoint hotspot;
+    };
+    // the images of the theme shapes already installed, cleared when the theme changes
+    QHash<int, ThemeCursor> m_themeCursors;
     bool m_handlesOutputs = false;
     bool m_ready = false;
     QSize m_initialWindowSize;
@@ -0,0 +1,68 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "mock_drm_device.h"
+
+namespace KWin
+{
+
+QVector<DrmDevice::Plane> MockDrmDevice::planes()
+{
+    return m_planes;
+}
+
+quint32 MockDrmDevice::propertyId(quint32 object, const QByteArray &name)
+{
+    const auto key = qMakePair(object, name);
+    auto it = m_properties.constFind(key);
+    if (it != m_properties.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = m_properties.count() + 1;
+    m_properties.insert(key, id);
+    return id;
+}
+
+bool MockDrmDevice::commit(const DrmAtomicRequest &request, bool testOnly, void *userData)
+{
+    Q_UNUSED(userData)
+    if (testOnly) {
+        m_testCommits++;
+        return !m_test || m_test(request);
+    }
+    m_commits++;
+    return true;
+}
+
+void MockDrmDevice::addPlane(quint32 id, PlaneType type, quint32 possibleCrtcs, const QVector<quint32> &formats)
+{
+    Plane plane;
+    plane.id = id;
+    plane.type = type;
+    plane.possibleCrtcs = possibleCrtcs;
+    plane.formats = formats;
+    m_planes << plane;
+}
+
+void MockDrmDevice::setTestFunction(const std::function<bool(const DrmAtomicRequest&)> &test)
+{
+    m_test = test;
+}
+
+}
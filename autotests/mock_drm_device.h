@@ -0,0 +1,59 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_MOCK_DRM_DEVICE_H
+#define KWIN_MOCK_DRM_DEVICE_H
+
+#include "../backends/drm/drm_device.h"
+
+#include <functional>
+
+namespace KWin
+{
+
+class MockDrmDevice : public DrmDevice
+{
+public:
+    QVector<Plane> planes() override;
+    quint32 propertyId(quint32 object, const QByteArray &name) override;
+    bool commit(const DrmAtomicRequest &request, bool testOnly, void *userData = nullptr) override;
+
+    void addPlane(quint32 id, PlaneType type, quint32 possibleCrtcs, const QVector<quint32> &formats);
+    /**
+     * Sets a function deciding whether a test-only commit succeeds, by default all succeed.
+     **/
+    void setTestFunction(const std::function<bool(const DrmAtomicRequest&)> &test);
+    int testCommits() const {
+        return m_testCommits;
+    }
+    int commits() const {
+        return m_commits;
+    }
+
+private:
+    QVector<Plane> m_planes;
+    QHash<QPair<quint32, QByteArray>, quint32> m_properties;
+    std::function<bool(const DrmAtomicRequest&)> m_test;
+    int m_testCommits = 0;
+    int m_commits = 0;
+};
+
+}
+
+#endif
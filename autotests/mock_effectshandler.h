@@ -193,6 +193,9 @@ public:
     KWin::EffectWindowList stackingOrder() const override {
         return KWin::EffectWindowList();
     }
+    KWin::EffectWindowList stackingOrderOnDesktop(int) const override {
+        return KWin::EffectWindowList();
+    }
     void startMouseInterception(KWin::Effect *, Qt::CursorShape) override {}
     void startMousePolling() override {}
     void stopMouseInterception(KWin::Effect *) override {}
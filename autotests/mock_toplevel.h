@@ -0,0 +1,60 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_MOCK_TOPLEVEL_H
+#define KWIN_MOCK_TOPLEVEL_H
+
+#include <netwm_def.h>
+
+#include <QString>
+#include <QStringList>
+
+namespace KWin
+{
+
+class Toplevel
+{
+public:
+    explicit Toplevel(int desktop = 1, const QStringList &activities = QStringList());
+
+    int desktop() const {
+        return m_desktop;
+    }
+    bool isOnAllDesktops() const {
+        return m_desktop == NET::OnAllDesktops;
+    }
+    bool isOnActivity(const QString &activity) const {
+        return m_activities.isEmpty() || m_activities.contains(activity);
+    }
+
+    void setDesktop(int desktop) {
+        m_desktop = desktop;
+    }
+    void setActivities(const QStringList &activities) {
+        m_activities = activities;
+    }
+
+private:
+    int m_desktop;
+    QStringList m_activities;
+};
+
+}
+
+#endif
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../effectloader.h"
 #include "../effects/effect_builtins.h"
 #include "mock_effectshandler.h"
+#include "../scripting/scriptcache.h" // for mocking ScriptCache::preload
 #include "../scripting/scriptedeffect.h" // for mocking ScriptedEffect::create
 // KDE
 #include <KConfig>
@@ -43,6 +44,15 @@ ScriptedEffect *ScriptedEffect::create(KService::Ptr)
     return nullptr;
 }
 
+QString ScriptedEffect::locateScript(KService::Ptr)
+{
+    return QString();
+}
+
+void ScriptCache::preload(const QStringList &)
+{
+}
+
 }
 
 class TestBuiltInEffectLoader : public QObject
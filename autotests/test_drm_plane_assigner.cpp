@@ -0,0 +1,260 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "mock_drm_device.h"
+#include "../backends/drm/drm_planes.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// the values do not matter for the assigner, they only have to differ
+static const quint32 s_xrgb = 1;
+static const quint32 s_argb = 2;
+
+static const quint32 s_crtc = 100;
+static const quint32 s_otherCrtc = 101;
+static const QSize s_outputSize = QSize(1920, 1080);
+
+class TestDrmPlaneAssigner : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testPrimary();
+    void testPrimaryNotCovering();
+    void testUnsupportedFormat();
+    void testOverlays();
+    void testOverlayNotPossibleForCrtc();
+    void testOverlayOwnedByOtherCrtc();
+    void testFailedTestCommit();
+    void testValidationSkipped();
+    void testDisableUnusedOverlay();
+    void testRelease();
+
+private:
+    static DrmLayer fullscreenLayer(quint32 framebuffer = 1);
+    static DrmLayer overlayLayer(const QRect &geometry, quint32 framebuffer = 2);
+};
+
+DrmLayer TestDrmPlaneAssigner::fullscreenLayer(quint32 framebuffer)
+{
+    DrmLayer layer;
+    layer.framebuffer = framebuffer;
+    layer.format = s_xrgb;
+    layer.size = s_outputSize;
+    layer.geometry = QRect(QPoint(0, 0), s_outputSize);
+    return layer;
+}
+
+DrmLayer TestDrmPlaneAssigner::overlayLayer(const QRect &geometry, quint32 framebuffer)
+{
+    DrmLayer layer;
+    layer.framebuffer = framebuffer;
+    layer.format = s_argb;
+    layer.size = geometry.size();
+    layer.geometry = geometry;
+    return layer;
+}
+
+void TestDrmPlaneAssigner::testPrimary()
+{
+    MockDrmDevice device;
+    device.addPlane(10, DrmDevice::PlaneType::Cursor, 0x1, {s_argb});
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    DrmPlaneAssigner assigner(&device);
+
+    const auto assignment = assigner.assign(s_crtc, 0, s_outputSize, {fullscreenLayer(42)});
+    QVERIFY(assignment.isValid());
+    QCOMPARE(assignment.planes, QVector<quint32>{11});
+    QCOMPARE(device.testCommits(), 1);
+    QCOMPARE(assignment.request.value(11, device.propertyId(11, QByteArrayLiteral("FB_ID"))), quint64(42));
+    QCOMPARE(assignment.request.value(11, device.propertyId(11, QByteArrayLiteral("CRTC_ID"))), quint64(s_crtc));
+    // source size is in 16.16 fixed point
+    QCOMPARE(assignment.request.value(11, device.propertyId(11, QByteArrayLiteral("SRC_W"))), quint64(1920) << 16);
+    QCOMPARE(assignment.request.value(11, device.propertyId(11, QByteArrayLiteral("CRTC_H"))), quint64(1080));
+}
+
+void TestDrmPlaneAssigner::testPrimaryNotCovering()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    DrmPlaneAssigner assigner(&device);
+
+    DrmLayer layer = fullscreenLayer();
+    layer.geometry = QRect(0, 0, 100, 100);
+    QVERIFY(!assigner.assign(s_crtc, 0, s_outputSize, {layer}).isValid());
+    QVERIFY(!assigner.assign(s_crtc, 0, s_outputSize, {}).isValid());
+    QCOMPARE(device.testCommits(), 0);
+}
+
+void TestDrmPlaneAssigner::testUnsupportedFormat()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_argb});
+    DrmPlaneAssigner assigner(&device);
+
+    QVERIFY(!assigner.assign(s_crtc, 0, s_outputSize, {fullscreenLayer()}).isValid());
+}
+
+void TestDrmPlaneAssigner::testOverlays()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    device.addPlane(12, DrmDevice::PlaneType::Overlay, 0x1, {s_argb});
+    device.addPlane(13, DrmDevice::PlaneType::Overlay, 0x1, {s_argb});
+    DrmPlaneAssigner assigner(&device);
+
+    const QVector<DrmLayer> layers{fullscreenLayer(), overlayLayer(QRect(10, 20, 100, 50), 2), overlayLayer(QRect(0, 0, 10, 10), 3)};
+    const auto assignment = assigner.assign(s_crtc, 0, s_outputSize, layers);
+    QCOMPARE(assignment.planes, (QVector<quint32>{11, 12, 13}));
+    QCOMPARE(assignment.request.value(12, device.propertyId(12, QByteArrayLiteral("CRTC_X"))), quint64(10));
+    QCOMPARE(assignment.request.value(12, device.propertyId(12, QByteArrayLiteral("CRTC_Y"))), quint64(20));
+    QCOMPARE(assignment.request.value(13, device.propertyId(13, QByteArrayLiteral("FB_ID"))), quint64(3));
+
+    // a fourth layer does not find a plane and has to be composited
+    QVector<DrmLayer> moreLayers = layers;
+    moreLayers << overlayLayer(QRect(50, 50, 10, 10), 4);
+    QCOMPARE(assigner.assign(s_crtc, 0, s_outputSize, moreLayers).planes, (QVector<quint32>{11, 12, 13}));
+}
+
+void TestDrmPlaneAssigner::testOverlayNotPossibleForCrtc()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    device.addPlane(12, DrmDevice::PlaneType::Overlay, 0x2, {s_argb});
+    device.addPlane(13, DrmDevice::PlaneType::Primary, 0x2, {s_xrgb});
+    DrmPlaneAssigner assigner(&device);
+
+    QCOMPARE(assigner.assign(s_crtc, 0, s_outputSize, {fullscreenLayer(), overlayLayer(QRect(0, 0, 10, 10))}).planes,
+             QVector<quint32>{11});
+    QCOMPARE(assigner.assign(s_otherCrtc, 1, s_outputSize, {fullscreenLayer(), overlayLayer(QRect(0, 0, 10, 10))}).planes,
+             (QVector<quint32>{13, 12}));
+}
+
+void TestDrmPlaneAssigner::testOverlayOwnedByOtherCrtc()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    device.addPlane(12, DrmDevice::PlaneType::Primary, 0x2, {s_xrgb});
+    device.addPlane(13, DrmDevice::PlaneType::Overlay, 0x3, {s_argb});
+    DrmPlaneAssigner assigner(&device);
+
+    const QVector<DrmLayer> layers{fullscreenLayer(), overlayLayer(QRect(0, 0, 10, 10))};
+    const auto assignment = assigner.assign(s_crtc, 0, s_outputSize, layers);
+    QCOMPARE(assignment.planes, (QVector<quint32>{11, 13}));
+    assigner.commit(s_crtc, assignment, layers);
+
+    QCOMPARE(assigner.assign(s_otherCrtc, 1, s_outputSize, layers).planes, QVector<quint32>{12});
+
+    // once released the overlay can be used by the other crtc
+    assigner.release(s_crtc);
+    QCOMPARE(assigner.assign(s_otherCrtc, 1, s_outputSize, layers).planes, (QVector<quint32>{12, 13}));
+}
+
+void TestDrmPlaneAssigner::testFailedTestCommit()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    device.addPlane(12, DrmDevice::PlaneType::Overlay, 0x1, {s_argb});
+    device.addPlane(13, DrmDevice::PlaneType::Overlay, 0x1, {s_argb});
+    const quint32 fbProperty = device.propertyId(13, QByteArrayLiteral("FB_ID"));
+    // the driver refuses to show anything on plane 13
+    device.setTestFunction([fbProperty] (const DrmAtomicRequest &request) {
+        return request.value(13, fbProperty) == 0;
+    });
+    DrmPlaneAssigner assigner(&device);
+
+    const QVector<DrmLayer> layers{fullscreenLayer(), overlayLayer(QRect(0, 0, 10, 10), 2), overlayLayer(QRect(0, 0, 20, 20), 3)};
+    QCOMPARE(assigner.assign(s_crtc, 0, s_outputSize, layers).planes, (QVector<quint32>{11, 12}));
+    QCOMPARE(device.testCommits(), 2);
+
+    // if nothing is accepted the assignment is invalid
+    device.setTestFunction([] (const DrmAtomicRequest&) {
+        return false;
+    });
+    QVERIFY(!assigner.assign(s_crtc, 0, s_outputSize, layers).isValid());
+}
+
+void TestDrmPlaneAssigner::testValidationSkipped()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    device.addPlane(12, DrmDevice::PlaneType::Overlay, 0x1, {s_argb});
+    DrmPlaneAssigner assigner(&device);
+
+    QVector<DrmLayer> layers{fullscreenLayer(1), overlayLayer(QRect(0, 0, 10, 10), 2)};
+    auto assignment = assigner.assign(s_crtc, 0, s_outputSize, layers);
+    QCOMPARE(device.testCommits(), 1);
+    assigner.commit(s_crtc, assignment, layers);
+
+    // only the framebuffers change
+    layers[0].framebuffer = 3;
+    layers[1].framebuffer = 4;
+    assignment = assigner.assign(s_crtc, 0, s_outputSize, layers);
+    QCOMPARE(assignment.planes, (QVector<quint32>{11, 12}));
+    QCOMPARE(device.testCommits(), 1);
+    QCOMPARE(assignment.request.value(12, device.propertyId(12, QByteArrayLiteral("FB_ID"))), quint64(4));
+
+    // moving the overlay needs a new validation
+    layers[1].geometry.moveTo(5, 5);
+    assigner.assign(s_crtc, 0, s_outputSize, layers);
+    QCOMPARE(device.testCommits(), 2);
+}
+
+void TestDrmPlaneAssigner::testDisableUnusedOverlay()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    device.addPlane(12, DrmDevice::PlaneType::Overlay, 0x1, {s_argb});
+    DrmPlaneAssigner assigner(&device);
+
+    const QVector<DrmLayer> layers{fullscreenLayer(), overlayLayer(QRect(0, 0, 10, 10), 2)};
+    const auto first = assigner.assign(s_crtc, 0, s_outputSize, layers);
+    assigner.commit(s_crtc, first, layers);
+
+    const auto second = assigner.assign(s_crtc, 0, s_outputSize, {fullscreenLayer()});
+    QCOMPARE(second.planes, QVector<quint32>{11});
+    const quint32 crtcProperty = device.propertyId(12, QByteArrayLiteral("CRTC_ID"));
+    QCOMPARE(second.request.value(12, crtcProperty, 1), quint64(0));
+    QCOMPARE(second.request.value(12, device.propertyId(12, QByteArrayLiteral("FB_ID")), 1), quint64(0));
+
+    // once committed the overlay is not disabled again
+    assigner.commit(s_crtc, second, {fullscreenLayer()});
+    const auto third = assigner.assign(s_crtc, 0, s_outputSize, {fullscreenLayer()});
+    QCOMPARE(third.request.value(12, crtcProperty, 1), quint64(1));
+}
+
+void TestDrmPlaneAssigner::testRelease()
+{
+    MockDrmDevice device;
+    device.addPlane(11, DrmDevice::PlaneType::Primary, 0x1, {s_xrgb});
+    DrmPlaneAssigner assigner(&device);
+
+    const QVector<DrmLayer> layers{fullscreenLayer()};
+    assigner.commit(s_crtc, assigner.assign(s_crtc, 0, s_outputSize, layers), layers);
+    QCOMPARE(device.testCommits(), 1);
+
+    // after a release the configuration has to be validated again
+    assigner.release(s_crtc);
+    QVERIFY(assigner.assign(s_crtc, 0, s_outputSize, layers).isValid());
+    QCOMPARE(device.testCommits(), 2);
+}
+
+QTEST_GUILESS_MAIN(TestDrmPlaneAssigner)
+#include "test_drm_plane_assigner.moc"
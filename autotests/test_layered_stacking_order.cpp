@@ -0,0 +1,367 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../layeredstackingorder.h"
+#include "mock_toplevel.h"
+
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// only used as a key by the LayeredStackingOrder
+class Group
+{
+};
+
+}
+
+using namespace KWin;
+
+typedef QVector<LayeredStackingOrder::Window> WindowList;
+
+class TestLayeredStackingOrder : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testLayers();
+    void testGroupActiveLayer();
+    void testTransient();
+    void testTransientChain();
+    void testGroupTransient();
+    void testRaise();
+    void testLower();
+    void testRestackAroundTransient();
+    void testRaiseTransient();
+    void testRaiseMainWindow();
+    void testRaiseIntoActiveGroup();
+    void testMoveTwoWindows();
+    void testLayerChanged();
+    void testAllMoves();
+private:
+    static LayeredStackingOrder::Window window(Toplevel *t, Layer layer, Group *group = nullptr, int screen = 0);
+    static LayeredStackingOrder::Window transient(Toplevel *t, Layer layer, const QVector<Toplevel*> &mainWindows, Group *group = nullptr);
+    static ToplevelList rebuilt(const WindowList &windows);
+    static WindowList moved(const WindowList &windows, int from, int to);
+    /**
+     * Updates @p order to the unconstrained order @p after and compares the result with a
+     * newly built order for @p after.
+     **/
+    static void verifyUpdate(LayeredStackingOrder &order, const WindowList &after);
+};
+
+LayeredStackingOrder::Window TestLayeredStackingOrder::window(Toplevel *t, Layer layer, Group *group, int screen)
+{
+    LayeredStackingOrder::Window w;
+    w.toplevel = t;
+    w.layer = layer;
+    w.group = group;
+    w.screen = screen;
+    return w;
+}
+
+LayeredStackingOrder::Window TestLayeredStackingOrder::transient(Toplevel *t, Layer layer, const QVector<Toplevel*> &mainWindows, Group *group)
+{
+    LayeredStackingOrder::Window w = window(t, layer, group);
+    w.mainWindows = mainWindows;
+    return w;
+}
+
+ToplevelList TestLayeredStackingOrder::rebuilt(const WindowList &windows)
+{
+    LayeredStackingOrder order;
+    return order.update(windows);
+}
+
+WindowList TestLayeredStackingOrder::moved(const WindowList &windows, int from, int to)
+{
+    WindowList result = windows;
+    const LayeredStackingOrder::Window w = result.takeAt(from);
+    result.insert(to, w);
+    return result;
+}
+
+void TestLayeredStackingOrder::verifyUpdate(LayeredStackingOrder &order, const WindowList &after)
+{
+    QCOMPARE(order.update(after), rebuilt(after));
+}
+
+void TestLayeredStackingOrder::testLayers()
+{
+    Toplevel desktop, normal1, normal2, dock, above;
+    const WindowList windows = WindowList()
+        << window(&normal1, NormalLayer)
+        << window(&desktop, DesktopLayer)
+        << window(&above, AboveLayer)
+        << window(&normal2, NormalLayer)
+        << window(&dock, DockLayer);
+    QCOMPARE(rebuilt(windows), ToplevelList() << &desktop << &normal1 << &normal2 << &dock << &above);
+}
+
+void TestLayeredStackingOrder::testGroupActiveLayer()
+{
+    // a window raised above an active fullscreen window of its group stays above it,
+    // unless it is kept below or on another screen
+    Group group;
+    Toplevel other, fullscreen, dialog, below, otherScreen;
+    const WindowList windows = WindowList()
+        << window(&other, NormalLayer)
+        << window(&fullscreen, ActiveLayer, &group)
+        << window(&dialog, NormalLayer, &group)
+        << window(&below, BelowLayer, &group)
+        << window(&otherScreen, NormalLayer, &group, 1);
+    QCOMPARE(rebuilt(windows), ToplevelList() << &below << &other << &otherScreen << &fullscreen << &dialog);
+}
+
+void TestLayeredStackingOrder::testTransient()
+{
+    Toplevel mainWindow, dialog, belowDialog, other;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    const WindowList windows = WindowList()
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow)
+        << main
+        << window(&other, NormalLayer)
+        << transient(&belowDialog, BelowLayer, QVector<Toplevel*>() << &mainWindow);
+    // both transients end up directly above their mainwindow, in their stacking order
+    QCOMPARE(rebuilt(windows), ToplevelList() << &mainWindow << &belowDialog << &dialog << &other);
+}
+
+void TestLayeredStackingOrder::testTransientChain()
+{
+    Toplevel mainWindow, dialog, subDialog, other;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    LayeredStackingOrder::Window d = transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow);
+    d.hasTransients = true;
+    const WindowList windows = WindowList()
+        << transient(&subDialog, NormalLayer, QVector<Toplevel*>() << &dialog)
+        << d
+        << main
+        << window(&other, NormalLayer);
+    QCOMPARE(rebuilt(windows), ToplevelList() << &mainWindow << &dialog << &subDialog << &other);
+}
+
+void TestLayeredStackingOrder::testGroupTransient()
+{
+    // a group transient is kept above the top most of its mainwindows
+    Group group;
+    Toplevel member1, member2, dialog, other1, other2;
+    LayeredStackingOrder::Window m1 = window(&member1, NormalLayer, &group);
+    m1.hasTransients = true;
+    LayeredStackingOrder::Window m2 = window(&member2, NormalLayer, &group);
+    m2.hasTransients = true;
+    const WindowList windows = WindowList()
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &member1 << &member2, &group)
+        << m1
+        << window(&other1, NormalLayer)
+        << m2
+        << window(&other2, NormalLayer);
+    QCOMPARE(rebuilt(windows), ToplevelList() << &member1 << &other1 << &member2 << &dialog << &other2);
+}
+
+void TestLayeredStackingOrder::testRaise()
+{
+    Toplevel desktop, mainWindow, dialog, normal1, normal2, dock;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    const WindowList windows = WindowList()
+        << window(&desktop, DesktopLayer)
+        << window(&normal1, NormalLayer)
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow)
+        << main
+        << window(&normal2, NormalLayer)
+        << window(&dock, DockLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+
+    // raising a window moves it to the top of its layer, below the dock
+    const WindowList raised = moved(windows, 1, windows.count() - 1);
+    verifyUpdate(order, raised);
+    QCOMPARE(order.update(raised), ToplevelList() << &desktop << &mainWindow << &dialog << &normal2 << &normal1 << &dock);
+    // raising it again does not change anything
+    verifyUpdate(order, raised);
+    // raising the desktop window keeps it in its layer
+    verifyUpdate(order, moved(raised, 0, raised.count() - 1));
+}
+
+void TestLayeredStackingOrder::testLower()
+{
+    Toplevel desktop, mainWindow, dialog, normal1, normal2, dock;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    const WindowList windows = WindowList()
+        << window(&desktop, DesktopLayer)
+        << window(&dock, DockLayer)
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow)
+        << main
+        << window(&normal1, NormalLayer)
+        << window(&normal2, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+
+    const WindowList lowered = moved(windows, 5, 0);
+    verifyUpdate(order, lowered);
+    QCOMPARE(order.update(lowered), ToplevelList() << &desktop << &normal2 << &mainWindow << &dialog << &normal1 << &dock);
+    verifyUpdate(order, moved(lowered, 2, 0));
+}
+
+void TestLayeredStackingOrder::testRestackAroundTransient()
+{
+    // a transient moved on top of its mainwindow stays directly above it wherever
+    // another window gets restacked
+    Toplevel mainWindow, dialog, normal;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    const WindowList windows = WindowList()
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow)
+        << main
+        << window(&normal, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), ToplevelList() << &mainWindow << &dialog << &normal);
+
+    verifyUpdate(order, moved(windows, 2, 0));
+    QCOMPARE(order.update(moved(windows, 2, 0)), ToplevelList() << &normal << &mainWindow << &dialog);
+    verifyUpdate(order, moved(windows, 2, 1));
+    QCOMPARE(order.update(moved(windows, 2, 1)), ToplevelList() << &normal << &mainWindow << &dialog);
+    verifyUpdate(order, windows);
+}
+
+void TestLayeredStackingOrder::testRaiseTransient()
+{
+    Toplevel mainWindow, dialog, normal1, normal2;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    const WindowList windows = WindowList()
+        << main
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow)
+        << window(&normal1, NormalLayer)
+        << window(&normal2, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+    verifyUpdate(order, moved(windows, 1, 3));
+    verifyUpdate(order, moved(windows, 1, 0));
+}
+
+void TestLayeredStackingOrder::testRaiseMainWindow()
+{
+    Toplevel mainWindow, dialog, normal1, normal2;
+    LayeredStackingOrder::Window main = window(&mainWindow, NormalLayer);
+    main.hasTransients = true;
+    const WindowList windows = WindowList()
+        << main
+        << window(&normal1, NormalLayer)
+        << transient(&dialog, NormalLayer, QVector<Toplevel*>() << &mainWindow)
+        << window(&normal2, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+    const WindowList raised = moved(windows, 0, 3);
+    verifyUpdate(order, raised);
+    QCOMPARE(order.update(raised), ToplevelList() << &normal1 << &normal2 << &mainWindow << &dialog);
+}
+
+void TestLayeredStackingOrder::testRaiseIntoActiveGroup()
+{
+    // raising a window above the active fullscreen window of its group moves it to the ActiveLayer
+    Group group;
+    Toplevel fullscreen, dialog, normal;
+    const WindowList windows = WindowList()
+        << window(&dialog, NormalLayer, &group)
+        << window(&fullscreen, ActiveLayer, &group)
+        << window(&normal, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), ToplevelList() << &dialog << &normal << &fullscreen);
+    const WindowList raised = moved(windows, 0, 2);
+    verifyUpdate(order, raised);
+    QCOMPARE(order.update(raised), ToplevelList() << &normal << &fullscreen << &dialog);
+    verifyUpdate(order, windows);
+}
+
+void TestLayeredStackingOrder::testMoveTwoWindows()
+{
+    Toplevel normal1, normal2, normal3, normal4;
+    const WindowList windows = WindowList()
+        << window(&normal1, NormalLayer)
+        << window(&normal2, NormalLayer)
+        << window(&normal3, NormalLayer)
+        << window(&normal4, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+    // swapping the outer windows needs a rebuild
+    WindowList swapped = windows;
+    std::swap(swapped[0], swapped[3]);
+    verifyUpdate(order, swapped);
+    QCOMPARE(order.update(swapped), ToplevelList() << &normal4 << &normal2 << &normal3 << &normal1);
+}
+
+void TestLayeredStackingOrder::testLayerChanged()
+{
+    Toplevel normal1, normal2, normal3;
+    WindowList windows = WindowList()
+        << window(&normal1, NormalLayer)
+        << window(&normal2, NormalLayer)
+        << window(&normal3, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+    windows[0].layer = AboveLayer;
+    verifyUpdate(order, windows);
+    QCOMPARE(order.update(windows), ToplevelList() << &normal2 << &normal3 << &normal1);
+    // and raised together with the layer change
+    windows[2].layer = BelowLayer;
+    verifyUpdate(order, moved(windows, 2, 0));
+}
+
+void TestLayeredStackingOrder::testAllMoves()
+{
+    // moves every window to every position one after the other, each result has to match
+    // a newly built order
+    Group group1, group2;
+    Toplevel desktop, main1, dialog1, subDialog1, groupDialog, member, normal1, normal2, dock, fullscreen, groupNormal;
+    LayeredStackingOrder::Window m1 = window(&main1, NormalLayer, &group1);
+    m1.hasTransients = true;
+    LayeredStackingOrder::Window d1 = transient(&dialog1, NormalLayer, QVector<Toplevel*>() << &main1, &group1);
+    d1.hasTransients = true;
+    LayeredStackingOrder::Window m = window(&member, NormalLayer, &group1);
+    m.hasTransients = true;
+    WindowList windows = WindowList()
+        << window(&normal1, NormalLayer)
+        << transient(&subDialog1, NormalLayer, QVector<Toplevel*>() << &dialog1, &group1)
+        << window(&desktop, DesktopLayer)
+        << d1
+        << window(&fullscreen, ActiveLayer, &group2)
+        << transient(&groupDialog, NormalLayer, QVector<Toplevel*>() << &main1 << &member, &group1)
+        << m1
+        << window(&dock, DockLayer)
+        << window(&groupNormal, NormalLayer, &group2)
+        << m
+        << window(&normal2, NormalLayer);
+    LayeredStackingOrder order;
+    QCOMPARE(order.update(windows), rebuilt(windows));
+    for (int from = 0; from < windows.count(); ++from) {
+        for (int to = 0; to < windows.count(); ++to) {
+            windows = moved(windows, from, to);
+            verifyUpdate(order, windows);
+        }
+    }
+}
+
+QTEST_MAIN(TestLayeredStackingOrder)
+#include "test_layered_stacking_order.moc"
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "../effectloader.h"
 #include "mock_effectshandler.h"
+#include "../scripting/scriptcache.h" // for mocking ScriptCache::preload
 #include "../scripting/scriptedeffect.h" // for mocking ScriptedEffect::create
 // KDE
 #include <KConfig>
@@ -42,6 +43,15 @@ ScriptedEffect *ScriptedEffect::create(KService::Ptr)
     return nullptr;
 }
 
+QString ScriptedEffect::locateScript(KService::Ptr)
+{
+    return QString();
+}
+
+void ScriptCache::preload(const QStringList &)
+{
+}
+
 }
 
 class TestPluginEffectLoader : public QObject
@@ -0,0 +1,306 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "mock_effectshandler.h"
+#include "../scene_scanout.h"
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+class MockEffectWindow : public EffectWindow
+{
+    Q_OBJECT
+public:
+    MockEffectWindow(QObject *parent = nullptr);
+    WindowQuadList buildQuads(bool force = false) const override;
+    QVariant data(int role) const override;
+    QRect decorationInnerRect() const override;
+    void deleteProperty(long int atom) const override;
+    void disablePainting(int reason) override;
+    void enablePainting(int reason) override;
+    EffectWindow *findModal() override;
+    const EffectWindowGroup *group() const override;
+    bool isPaintingEnabled() override;
+    EffectWindowList mainWindows() const override;
+    QByteArray readProperty(long int atom, long int type, int format) const override;
+    void refWindow() override;
+    void unrefWindow() override;
+    QRegion shape() const override;
+    void setData(int role, const QVariant &data) override;
+    void referencePreviousWindowPixmap() override {}
+    void unreferencePreviousWindowPixmap() override {}
+private:
+    int m_disablePainting;
+};
+
+MockEffectWindow::MockEffectWindow(QObject *parent)
+    : EffectWindow(parent)
+    , m_disablePainting(0)
+{
+}
+
+WindowQuadList MockEffectWindow::buildQuads(bool force) const
+{
+    Q_UNUSED(force)
+    return WindowQuadList();
+}
+
+QVariant MockEffectWindow::data(int role) const
+{
+    Q_UNUSED(role)
+    return QVariant();
+}
+
+QRect MockEffectWindow::decorationInnerRect() const
+{
+    return QRect();
+}
+
+void MockEffectWindow::deleteProperty(long int atom) const
+{
+    Q_UNUSED(atom)
+}
+
+void MockEffectWindow::disablePainting(int reason)
+{
+    m_disablePainting |= reason;
+}
+
+void MockEffectWindow::enablePainting(int reason)
+{
+    m_disablePainting &= ~reason;
+}
+
+EffectWindow *MockEffectWindow::findModal()
+{
+    return nullptr;
+}
+
+const EffectWindowGroup *MockEffectWindow::group() const
+{
+    return nullptr;
+}
+
+bool MockEffectWindow::isPaintingEnabled()
+{
+    return m_disablePainting == 0;
+}
+
+EffectWindowList MockEffectWindow::mainWindows() const
+{
+    return EffectWindowList();
+}
+
+QByteArray MockEffectWindow::readProperty(long int atom, long int type, int format) const
+{
+    Q_UNUSED(atom)
+    Q_UNUSED(type)
+    Q_UNUSED(format)
+    return QByteArray();
+}
+
+void MockEffectWindow::refWindow()
+{
+}
+
+void MockEffectWindow::setData(int role, const QVariant &data)
+{
+    Q_UNUSED(role)
+    Q_UNUSED(data)
+}
+
+QRegion MockEffectWindow::shape() const
+{
+    return QRegion();
+}
+
+void MockEffectWindow::unrefWindow()
+{
+}
+
+/**
+ * Runs the pre paint passes through the loaded effects like the EffectsHandlerImpl does.
+ **/
+class ChainEffectsHandler : public MockEffectsHandler
+{
+    Q_OBJECT
+public:
+    ChainEffectsHandler();
+    void setEffects(const QVector<Effect*> &effects);
+    void prePaintScreen(ScreenPrePaintData &data, int time) override;
+    void prePaintWindow(EffectWindow *w, WindowPrePaintData &data, int time) override;
+private:
+    QVector<Effect*> m_effects;
+    QVector<Effect*>::const_iterator m_currentPaintScreenIterator;
+    QVector<Effect*>::const_iterator m_currentPaintWindowIterator;
+};
+
+ChainEffectsHandler::ChainEffectsHandler()
+    : MockEffectsHandler(KWin::OpenGL2Compositing)
+{
+    setEffects(QVector<Effect*>());
+}
+
+void ChainEffectsHandler::setEffects(const QVector<Effect*> &effects)
+{
+    m_effects = effects;
+    m_currentPaintScreenIterator = m_effects.constBegin();
+    m_currentPaintWindowIterator = m_effects.constBegin();
+}
+
+void ChainEffectsHandler::prePaintScreen(ScreenPrePaintData &data, int time)
+{
+    if (m_currentPaintScreenIterator != m_effects.constEnd()) {
+        (*m_currentPaintScreenIterator++)->prePaintScreen(data, time);
+        --m_currentPaintScreenIterator;
+    }
+}
+
+void ChainEffectsHandler::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, int time)
+{
+    if (m_currentPaintWindowIterator != m_effects.constEnd()) {
+        (*m_currentPaintWindowIterator++)->prePaintWindow(w, data, time);
+        --m_currentPaintWindowIterator;
+    }
+}
+
+/**
+ * An Effect which is always active and changes the masks as configured.
+ **/
+class MaskEffect : public Effect
+{
+    Q_OBJECT
+public:
+    MaskEffect(int screenMask = 0, int windowMask = 0, bool translucent = false, bool disablePainting = false);
+    void prePaintScreen(ScreenPrePaintData &data, int time) override;
+    void prePaintWindow(EffectWindow *w, WindowPrePaintData &data, int time) override;
+    int lastTime() const {
+        return m_lastTime;
+    }
+private:
+    int m_screenMask;
+    int m_windowMask;
+    bool m_translucent;
+    bool m_disablePainting;
+    int m_lastTime;
+};
+
+MaskEffect::MaskEffect(int screenMask, int windowMask, bool translucent, bool disablePainting)
+    : Effect()
+    , m_screenMask(screenMask)
+    , m_windowMask(windowMask)
+    , m_translucent(translucent)
+    , m_disablePainting(disablePainting)
+    , m_lastTime(-1)
+{
+}
+
+void MaskEffect::prePaintScreen(ScreenPrePaintData &data, int time)
+{
+    m_lastTime = time;
+    data.mask |= m_screenMask;
+    effects->prePaintScreen(data, time);
+}
+
+void MaskEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, int time)
+{
+    m_lastTime = time;
+    data.mask |= m_windowMask;
+    if (m_translucent) {
+        data.setTranslucent();
+    }
+    if (m_disablePainting) {
+        w->disablePainting(EffectWindow::PAINT_DISABLED_BY_MINIMIZE);
+    }
+    effects->prePaintWindow(w, data, time);
+}
+
+class TestSceneScanout : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testNoEffects();
+    void testAlwaysActiveEffect();
+    void testChangingEffect_data();
+    void testChangingEffect();
+};
+
+void TestSceneScanout::testNoEffects()
+{
+    ChainEffectsHandler handler;
+    MockEffectWindow w;
+    QVERIFY(effectsKeepWindowUnchanged(&w, QRegion(0, 0, 1280, 1024)));
+}
+
+void TestSceneScanout::testAlwaysActiveEffect()
+{
+    // an Effect which is active but leaves the window alone, like blur or background contrast
+    // do for opaque windows, must not prevent the scanout
+    ChainEffectsHandler handler;
+    Effect plain;
+    MaskEffect effect;
+    QVERIFY(plain.isActive());
+    QVERIFY(effect.isActive());
+    handler.setEffects(QVector<Effect*>() << &plain << &effect);
+
+    MockEffectWindow w;
+    QVERIFY(effectsKeepWindowUnchanged(&w, QRegion(0, 0, 1280, 1024)));
+    // animations must not progress
+    QCOMPARE(effect.lastTime(), 0);
+}
+
+void TestSceneScanout::testChangingEffect_data()
+{
+    QTest::addColumn<int>("screenMask");
+    QTest::addColumn<int>("windowMask");
+    QTest::addColumn<bool>("translucent");
+    QTest::addColumn<bool>("disablePainting");
+    QTest::addColumn<bool>("expected");
+
+    QTest::newRow("none") << 0 << 0 << false << false << true;
+    QTest::newRow("background first") << int(Effect::PAINT_SCREEN_BACKGROUND_FIRST) << 0 << false << false << true;
+    QTest::newRow("lanczos") << 0 << int(Effect::PAINT_WINDOW_LANCZOS) << false << false << true;
+    QTest::newRow("screen transformed") << int(Effect::PAINT_SCREEN_TRANSFORMED) << 0 << false << false << false;
+    QTest::newRow("transformed windows") << int(Effect::PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS) << 0 << false << false << false;
+    QTest::newRow("window transformed") << 0 << int(Effect::PAINT_WINDOW_TRANSFORMED) << false << false << false;
+    QTest::newRow("window screen transformed") << 0 << int(Effect::PAINT_SCREEN_TRANSFORMED) << false << false << false;
+    QTest::newRow("translucent") << 0 << 0 << true << false << false;
+    QTest::newRow("painting disabled") << 0 << 0 << false << true << false;
+}
+
+void TestSceneScanout::testChangingEffect()
+{
+    QFETCH(int, screenMask);
+    QFETCH(int, windowMask);
+    QFETCH(bool, translucent);
+    QFETCH(bool, disablePainting);
+
+    ChainEffectsHandler handler;
+    MaskEffect alwaysActive;
+    MaskEffect effect(screenMask, windowMask, translucent, disablePainting);
+    // the changing effect is not the first one in the chain
+    handler.setEffects(QVector<Effect*>() << &alwaysActive << &effect);
+
+    MockEffectWindow w;
+    QTEST(effectsKeepWindowUnchanged(&w, QRegion(0, 0, 1280, 1024)), "expected");
+}
+
+QTEST_MAIN(TestSceneScanout)
+#include "test_scene_scanout.moc"
@@ -126,6 +126,7 @@ private Q_SLOTS:
     void testCreatingInitialEdges();
     void testCallback();
     void testCallbackWithCheck();
+    void testCheckApproaching();
     void testPushBack_data();
     void testPushBack();
     void testFullScreenBlocking();
@@ -538,12 +539,12 @@ void TestScreenEdges::testCallbackWithCheck()
     s->reserve(ElectricLeft, &callback, "callback");
 
     // check activating a different edge doesn't do anything
-    s->check(QPoint(50, 0), QDateTime::currentDateTime(), true);
+    s->check(QPoint(50, 0), true);
     QVERIFY(spy.isEmpty());
 
     // try a direct activate without pushback
     Cursor::setPos(0, 50);
-    s->check(QPoint(0, 50), QDateTime::currentDateTime(), true);
+    s->check(QPoint(0, 50), true);
     QCOMPARE(spy.count(), 1);
     QEXPECT_FAIL("", "Argument says force no pushback, but it gets pushed back. Needs investigation", Continue);
     QCOMPARE(Cursor::pos(), QPoint(0, 50));
@@ -551,19 +552,56 @@ void TestScreenEdges::testCallbackWithCheck()
     // use a different edge, this time with pushback
     s->reserve(KWin::ElectricRight, &callback, "callback");
     Cursor::setPos(99, 50);
-    s->check(QPoint(99, 50), QDateTime::currentDateTime());
+    s->check(QPoint(99, 50));
     QCOMPARE(spy.count(), 1);
     QCOMPARE(spy.last().first().value<ElectricBorder>(), ElectricLeft);
     QCOMPARE(Cursor::pos(), QPoint(98, 50));
     // and trigger it again
     QTest::qWait(160);
     Cursor::setPos(99, 50);
-    s->check(QPoint(99, 50), QDateTime::currentDateTime());
+    s->check(QPoint(99, 50));
     QCOMPARE(spy.count(), 2);
     QCOMPARE(spy.last().first().value<ElectricBorder>(), ElectricRight);
     QCOMPARE(Cursor::pos(), QPoint(98, 50));
 }
 
+void TestScreenEdges::testCheckApproaching()
+{
+    using namespace KWin;
+    auto s = ScreenEdges::self();
+    s->init();
+    TestObject callback;
+    QSignalSpy spy(&callback, SIGNAL(gotCallback(KWin::ElectricBorder)));
+    QVERIFY(spy.isValid());
+    s->reserve(ElectricTopLeft, &callback, "callback");
+    const QList<Edge*> edges = s->findChildren<Edge*>(QString(), Qt::FindDirectChildrenOnly);
+    auto it = std::find_if(edges.constBegin(), edges.constEnd(), [](Edge *e) {
+        return e->border() == ElectricTopLeft;
+    });
+    QVERIFY(it != edges.constEnd());
+    Edge *edge = *it;
+    QVERIFY(!edge->isApproaching());
+
+    // a position away from all borders doesn't hit any edge
+    s->check(QPoint(50, 50), true);
+    QVERIFY(spy.isEmpty());
+    QVERIFY(!edge->isApproaching());
+
+    // inside the approach area the corner starts approaching without triggering
+    s->check(edge->approachGeometry().center(), true);
+    QVERIFY(spy.isEmpty());
+    QVERIFY(edge->isApproaching());
+
+    // and on the corner it triggers
+    Cursor::setPos(0, 0);
+    s->check(QPoint(0, 0), true);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().value<ElectricBorder>(), ElectricTopLeft);
+
+    s->unreserve(ElectricTopLeft, &callback);
+    QVERIFY(!edge->isApproaching());
+}
+
 void TestScreenEdges::testPushBack_data()
 {
     QTest::addColumn<KWin::ElectricBorder>("border");
@@ -619,7 +657,7 @@ void TestScreenEdges::testPushBack()
 
     // do the same without the event, but the check method
     Cursor::setPos(trigger);
-    s->check(trigger, QDateTime::currentDateTime());
+    s->check(trigger);
     QVERIFY(spy.isEmpty());
     QTEST(Cursor::pos(), "expected");
 }
@@ -830,13 +868,13 @@ void TestScreenEdges::testClientEdge()
     s->reserve(&client, KWin::ElectricTop);
     QCOMPARE(client.isHiddenInternal(), true);
     Cursor::setPos(50, 0);
-    s->check(QPoint(50, 0), QDateTime::currentDateTime());
+    s->check(QPoint(50, 0));
     QCOMPARE(client.isHiddenInternal(), true);
     QCOMPARE(Cursor::pos(), QPoint(50, 1));
     // and trigger
     QTest::qWait(160);
     Cursor::setPos(50, 0);
-    s->check(QPoint(50, 0), QDateTime::currentDateTime());
+    s->check(QPoint(50, 0));
     QCOMPARE(client.isHiddenInternal(), false);
     QCOMPARE(Cursor::pos(), QPoint(50, 1));
 
@@ -845,7 +883,7 @@ void TestScreenEdges::testClientEdge()
     // check on previous edge again, should fail
     client.setHiddenInternal(true);
     Cursor::setPos(50, 0);
-    s->check(QPoint(50, 0), QDateTime::currentDateTime());
+    s->check(QPoint(50, 0));
     QCOMPARE(client.isHiddenInternal(), true);
     QCOMPARE(Cursor::pos(), QPoint(50, 0));
 }
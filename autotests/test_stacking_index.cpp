@@ -0,0 +1,251 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../stackingindex.h"
+#include "../input.h"
+#include "../virtualdesktops.h"
+#include "mock_toplevel.h"
+
+#include <QAction>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+namespace KWin {
+
+int screen_number = 0;
+
+InputRedirection *InputRedirection::s_self = nullptr;
+
+void InputRedirection::registerShortcut(const QKeySequence &shortcut, QAction *action)
+{
+    Q_UNUSED(shortcut)
+    Q_UNUSED(action)
+}
+
+void InputRedirection::registerAxisShortcut(Qt::KeyboardModifiers modifiers, PointerAxisDirection axis, QAction *action)
+{
+    Q_UNUSED(modifiers)
+    Q_UNUSED(axis)
+    Q_UNUSED(action)
+}
+
+void InputRedirection::registerShortcutForGlobalAccelTimestamp(QAction *action)
+{
+    Q_UNUSED(action)
+}
+
+}
+
+using namespace KWin;
+
+class TestStackingIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void testAdd_data();
+    void testAdd();
+    void testRemove();
+    void testReplace();
+    void testRaise();
+    void testLower();
+    void testSwap();
+    void testReorder();
+    void testDesktopChanged();
+    void testActivitiesChanged();
+    void testDesktopCountChanged();
+private:
+    /**
+     * Compares the lists of @p index for all desktops and the activities with the ones of a
+     * newly built index for @p stacking.
+     **/
+    void verify(StackingIndex *index, const ToplevelList &stacking);
+    // windows on desktop 1, 2, all desktops, 1, 2 and 3, bottom most first
+    QList<Toplevel*> m_windows;
+    ToplevelList m_stacking;
+    StackingIndex *m_index = nullptr;
+};
+
+void TestStackingIndex::initTestCase()
+{
+    VirtualDesktopManager::create();
+    VirtualDesktopManager::self()->setCount(3);
+}
+
+void TestStackingIndex::cleanupTestCase()
+{
+    delete VirtualDesktopManager::self();
+}
+
+void TestStackingIndex::init()
+{
+    VirtualDesktopManager::self()->setCount(3);
+    m_windows << new Toplevel(1, QStringList{QStringLiteral("a")})
+              << new Toplevel(2)
+              << new Toplevel(NET::OnAllDesktops, QStringList{QStringLiteral("b")})
+              << new Toplevel(1)
+              << new Toplevel(2, QStringList{QStringLiteral("a"), QStringLiteral("b")})
+              << new Toplevel(3, QStringList{QStringLiteral("b")});
+    m_stacking = m_windows;
+    m_index = new StackingIndex;
+    // creates the activity lists, so that they get updated as well
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::cleanup()
+{
+    delete m_index;
+    m_index = nullptr;
+    m_stacking.clear();
+    qDeleteAll(m_windows);
+    m_windows.clear();
+}
+
+void TestStackingIndex::verify(StackingIndex *index, const ToplevelList &stacking)
+{
+    StackingIndex rebuilt;
+    for (uint desktop = 1; desktop <= VirtualDesktopManager::self()->count(); ++desktop) {
+        QCOMPARE(index->onDesktop(stacking, desktop), rebuilt.onDesktop(stacking, desktop));
+    }
+    QVERIFY(index->onDesktop(stacking, 0).isEmpty());
+    const QStringList activities{QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c")};
+    for (const QString &activity : activities) {
+        QCOMPARE(index->onActivity(stacking, activity), rebuilt.onActivity(stacking, activity));
+    }
+}
+
+void TestStackingIndex::testAdd_data()
+{
+    QTest::addColumn<int>("position");
+    QTest::addColumn<int>("desktop");
+
+    QTest::newRow("bottom") << 0 << 1;
+    QTest::newRow("middle") << 3 << 2;
+    QTest::newRow("top") << 6 << 1;
+    QTest::newRow("all desktops") << 2 << int(NET::OnAllDesktops);
+}
+
+void TestStackingIndex::testAdd()
+{
+    QFETCH(int, position);
+    QFETCH(int, desktop);
+    Toplevel *t = new Toplevel(desktop);
+    m_windows << t;
+    m_stacking.insert(position, t);
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testRemove()
+{
+    m_stacking.removeAt(2);
+    verify(m_index, m_stacking);
+    m_stacking.removeLast();
+    verify(m_index, m_stacking);
+    m_stacking.removeFirst();
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testReplace()
+{
+    // like a closed window replaced by its Deleted
+    Toplevel *t = new Toplevel(3, QStringList{QStringLiteral("a")});
+    m_windows << t;
+    m_stacking[3] = t;
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testRaise()
+{
+    m_stacking.append(m_stacking.takeAt(1));
+    verify(m_index, m_stacking);
+    // window on all desktops
+    m_stacking.move(1, 4);
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testLower()
+{
+    m_stacking.prepend(m_stacking.takeLast());
+    verify(m_index, m_stacking);
+    m_stacking.move(4, 2);
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testSwap()
+{
+    m_stacking.swap(2, 3);
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testReorder()
+{
+    // more than one window moved, falls back to a rebuild
+    std::reverse(m_stacking.begin(), m_stacking.end());
+    verify(m_index, m_stacking);
+    m_stacking.swap(0, 5);
+    m_stacking.swap(1, 3);
+    verify(m_index, m_stacking);
+    // and keeps working incrementally afterwards
+    m_stacking.append(m_stacking.takeFirst());
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testDesktopChanged()
+{
+    Toplevel *t = m_windows.at(3);
+    t->setDesktop(2);
+    m_index->updateDesktop(t);
+    verify(m_index, m_stacking);
+    t->setDesktop(NET::OnAllDesktops);
+    m_index->updateDesktop(t);
+    verify(m_index, m_stacking);
+    // from all desktops to one, together with a raise
+    t = m_windows.at(2);
+    t->setDesktop(3);
+    m_index->updateDesktop(t);
+    m_stacking.append(m_stacking.takeAt(2));
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testActivitiesChanged()
+{
+    Toplevel *t = m_windows.at(1);
+    t->setActivities(QStringList{QStringLiteral("c")});
+    m_index->updateActivities(t);
+    verify(m_index, m_stacking);
+    t = m_windows.at(4);
+    t->setActivities(QStringList());
+    m_index->updateActivities(t);
+    verify(m_index, m_stacking);
+}
+
+void TestStackingIndex::testDesktopCountChanged()
+{
+    VirtualDesktopManager::self()->setCount(2);
+    verify(m_index, m_stacking);
+    VirtualDesktopManager::self()->setCount(4);
+    verify(m_index, m_stacking);
+}
+
+QTEST_MAIN(TestStackingIndex)
+#include "test_stacking_index.moc"
@@ -20,6 +20,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "drm_backend.h"
 #include "composite.h"
 #include "cursor.h"
+#include "drm_device.h"
+#include "drm_planes.h"
 #include "logging.h"
 #include "logind.h"
 #include "scene_qpainter_drm_backend.h"
@@ -31,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "egl_gbm_backend.h"
 #endif
 // KWayland
+#include <KWayland/Server/buffer_interface.h>
 #include <KWayland/Server/display.h>
 #include <KWayland/Server/output_interface.h>
 // KF5
@@ -46,6 +49,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // drm
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include <libdrm/drm_fourcc.h>
 #include <libdrm/drm_mode.h>
 #if HAVE_GBM
 #include <gbm.h>
@@ -62,6 +66,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 
+// upper bound for the theme cursor images kept in buffers, only a few shapes are in regular use
+static const int s_cursorCacheSize = 16;
+
 DrmBackend::DrmBackend(QObject *parent)
     : AbstractBackend(parent)
     , m_udev(new Udev)
@@ -79,9 +86,17 @@ DrmBackend::~DrmBackend()
         while (m_pageFlipsPending != 0) {
             QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
         }
-        qDeleteAll(m_outputs);
+        // outputs release their buffers on destruction, which must not look at deleted outputs
+        const auto outputs = m_outputs;
+        m_outputs.clear();
+        qDeleteAll(outputs);
         delete m_cursor[0];
         delete m_cursor[1];
+        qDeleteAll(m_cursorCache);
+        delete m_staleCursor;
+        const auto clientBuffers = m_clientBuffers;
+        m_clientBuffers.clear();
+        qDeleteAll(clientBuffers);
         close(m_fd);
     }
 }
@@ -121,19 +136,20 @@ void DrmBackend::reactivate()
         return;
     }
     m_active = true;
-    DrmBuffer *c = m_cursor[(m_cursorIndex + 1) % 2];
     const QPoint cp = Cursor::pos() - softwareCursorHotspot();
     for (auto it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it) {
         DrmOutput *o = *it;
         o->pageFlipped();
         o->blank();
-        o->showCursor(c);
-        o->moveCursor(cp);
+        if (m_currentCursor) {
+            o->showCursor(m_currentCursor);
+            o->moveCursor(cp);
+        }
     }
     // restart compositor
     m_pageFlipsPending = 0;
+    unblockCompositor();
     if (Compositor *compositor = Compositor::self()) {
-        compositor->bufferSwapComplete();
         compositor->addRepaintFull();
     }
 }
@@ -144,8 +160,9 @@ void DrmBackend::deactivate()
         return;
     }
     // block compositor
-    if (m_pageFlipsPending == 0 && Compositor::self()) {
+    if (!m_compositorBlocked && Compositor::self()) {
         Compositor::self()->aboutToSwapBuffers();
+        m_compositorBlocked = true;
     }
     // hide cursor and disable
     for (auto it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it) {
@@ -163,14 +180,45 @@ void DrmBackend::pageFlipHandler(int fd, unsigned int frame, unsigned int sec, u
     Q_UNUSED(sec)
     Q_UNUSED(usec)
     auto output = reinterpret_cast<DrmOutput*>(data);
+    if (!output->isPageFlipPending()) {
+        // stale event, e.g. the output got reset while the session was inactive
+        return;
+    }
     output->pageFlipped();
-    output->m_backend->m_pageFlipsPending--;
-    if (output->m_backend->m_pageFlipsPending == 0) {
-        // TODO: improve, this currently means we wait for all page flips or all outputs.
-        // It would be better to driver the repaint per output
-        if (Compositor::self()) {
-            Compositor::self()->bufferSwapComplete();
+    DrmBackend *backend = output->m_backend;
+    backend->m_pageFlipsPending--;
+    // each output is driven by its own page flips: as soon as one output can take a new
+    // frame the Compositor may render the damage on it, without waiting for the other outputs
+    backend->unblockCompositor();
+    if (Compositor *compositor = Compositor::self()) {
+        compositor->screenFrameCompleted(output->geometry());
+    }
+}
+
+void DrmBackend::blockCompositorIfBusy()
+{
+    if (m_compositorBlocked || !Compositor::self()) {
+        return;
+    }
+    const bool busy = std::all_of(m_outputs.constBegin(), m_outputs.constEnd(),
+        [] (DrmOutput *o) {
+            return o->isPageFlipPending();
         }
+    );
+    if (busy) {
+        Compositor::self()->aboutToSwapBuffers();
+        m_compositorBlocked = true;
+    }
+}
+
+void DrmBackend::unblockCompositor()
+{
+    if (!m_compositorBlocked) {
+        return;
+    }
+    m_compositorBlocked = false;
+    if (Compositor *compositor = Compositor::self()) {
+        compositor->bufferSwapComplete();
     }
 }
 
@@ -190,6 +238,13 @@ void DrmBackend::openDrm()
     }
     m_fd = fd;
     m_active = true;
+    if (qEnvironmentVariableIsSet("KWIN_DRM_AMS")) {
+        m_atomicDevice.reset(DrmAtomicDevice::create(m_fd));
+        if (m_atomicDevice) {
+            qCDebug(KWIN_DRM) << "Using atomic mode setting";
+            m_planeAssigner.reset(new DrmPlaneAssigner(m_atomicDevice.data()));
+        }
+    }
     QSocketNotifier *notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
     connect(notifier, &QSocketNotifier::activated, this,
         [this] {
@@ -286,6 +341,12 @@ void DrmBackend::queryResources()
         }
         DrmOutput *drmOutput = new DrmOutput(this);
         drmOutput->m_crtcId = crtcId;
+        for (int j = 0; j < resources->count_crtcs; ++j) {
+            if (resources->crtcs[j] == crtcId) {
+                drmOutput->m_crtcIndex = j;
+                break;
+            }
+        }
         if (crtc->mode_valid) {
             drmOutput->m_mode = crtc->mode;
         } else {
@@ -304,6 +365,9 @@ void DrmBackend::queryResources()
         }
         DrmOutput *removed = *it;
         it = m_outputs.erase(it);
+        if (m_planeAssigner) {
+            m_planeAssigner->release(removed->m_crtcId);
+        }
         emit outputRemoved(removed);
         delete removed;
     }
@@ -373,14 +437,19 @@ bool DrmBackend::crtcIsUsed(quint32 crtc)
     return it != m_outputs.constEnd();
 }
 
-void DrmBackend::present(DrmBuffer *buffer, DrmOutput *output)
+bool DrmBackend::present(DrmBuffer *buffer, DrmOutput *output)
 {
+    if (buffer && buffer->isClientBuffer() && !buffer->m_locked && buffer->m_clientBuffer) {
+        // the client must not reuse the buffer while it is on screen
+        buffer->m_clientBuffer->ref();
+        buffer->m_locked = true;
+    }
     if (output->present(buffer)) {
         m_pageFlipsPending++;
-        if (m_pageFlipsPending == 1 && Compositor::self()) {
-            Compositor::self()->aboutToSwapBuffers();
-        }
+        blockCompositorIfBusy();
+        return true;
     }
+    return false;
 }
 
 void DrmBackend::installCursorFromServer()
@@ -416,36 +485,85 @@ void DrmBackend::initCursor()
     // now we have screens and can set cursors, so start tracking
     connect(this, &DrmBackend::cursorChanged, this, &DrmBackend::updateCursor);
     connect(Cursor::self(), &Cursor::posChanged, this, &DrmBackend::moveCursor);
+    connect(Cursor::self(), &Cursor::themeChanged, this, &DrmBackend::clearCursorCache);
     installCursorImage(Qt::ArrowCursor);
 }
 
-void DrmBackend::setCursor()
+void DrmBackend::setCursor(DrmBuffer *buffer)
 {
-    DrmBuffer *c = m_cursor[m_cursorIndex];
-    m_cursorIndex = (m_cursorIndex + 1) % 2;
+    m_currentCursor = buffer;
     for (auto it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it) {
-        (*it)->showCursor(c);
+        (*it)->showCursor(buffer);
+    }
+    if (m_staleCursor && m_staleCursor != buffer) {
+        delete m_staleCursor;
+        m_staleCursor = nullptr;
     }
 }
 
+static void paintCursor(DrmBuffer *buffer, const QImage &cursorImage)
+{
+    QImage *c = buffer->image();
+    c->fill(Qt::transparent);
+    QPainter p;
+    p.begin(c);
+    p.drawImage(QPoint(0, 0), cursorImage);
+    p.end();
+}
+
 void DrmBackend::updateCursor()
 {
     const QImage &cursorImage = softwareCursor();
     if (cursorImage.isNull()) {
+        m_currentCursor = nullptr;
         hideCursor();
         return;
     }
-    QImage *c = m_cursor[m_cursorIndex]->image();
-    c->fill(Qt::transparent);
-    QPainter p;
-    p.begin(c);
-    p.drawImage(QPoint(0, 0), cursorImage);
-    p.end();
+    DrmBuffer *c = nullptr;
+    if (isThemeCursor()) {
+        c = themeCursorBuffer(cursorImage);
+    }
+    if (!c) {
+        c = m_cursor[m_cursorIndex];
+        m_cursorIndex = (m_cursorIndex + 1) % 2;
+        paintCursor(c, cursorImage);
+    }
 
-    setCursor();
+    setCursor(c);
     moveCursor();
 }
 
+DrmBuffer *DrmBackend::themeCursorBuffer(const QImage &image)
+{
+    const qint64 key = image.cacheKey();
+    if (DrmBuffer *c = m_cursorCache.value(key)) {
+        return c;
+    }
+    if (m_cursorCache.count() >= s_cursorCacheSize) {
+        return nullptr;
+    }
+    DrmBuffer *c = createBuffer(m_cursor[0]->size());
+    if (!c->map(QImage::Format_ARGB32_Premultiplied)) {
+        delete c;
+        return nullptr;
+    }
+    paintCursor(c, image);
+    m_cursorCache.insert(key, c);
+    return c;
+}
+
+void DrmBackend::clearCursorCache()
+{
+    for (auto it = m_cursorCache.constBegin(); it != m_cursorCache.constEnd(); ++it) {
+        if (it.value() == m_currentCursor) {
+            m_staleCursor = it.value();
+        } else {
+            delete it.value();
+        }
+    }
+    m_cursorCache.clear();
+}
+
 void DrmBackend::hideCursor()
 {
     for (auto it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it) {
@@ -490,25 +608,83 @@ OpenGLBackend *DrmBackend::createOpenGLBackend()
 
 DrmBuffer *DrmBackend::createBuffer(const QSize &size)
 {
-    DrmBuffer *b = new DrmBuffer(this, size);
-    m_buffers << b;
+    return new DrmBuffer(this, size);
+}
+
+DrmBuffer *DrmBackend::createBuffer(gbm_bo *bo, KWayland::Server::BufferInterface *clientBuffer)
+{
+    DrmBuffer *b = new DrmBuffer(this, bo, clientBuffer);
+    m_clientBuffers.insert(clientBuffer, b);
+    connect(clientBuffer, &QObject::destroyed, this,
+        [this, clientBuffer] {
+            DrmBuffer *b = m_clientBuffers.take(clientBuffer);
+            // a presented buffer gets destroyed once it is released
+            if (b && !b->m_locked) {
+                delete b;
+            }
+        }
+    );
     return b;
 }
 
-DrmBuffer *DrmBackend::createBuffer(gbm_surface *surface)
+void DrmBackend::releaseClientBuffer(DrmBuffer *buffer)
+{
+    for (auto it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it) {
+        if ((*it)->m_queuedBuffer == buffer || (*it)->m_scanoutBuffer == buffer) {
+            return;
+        }
+    }
+    if (buffer->m_locked) {
+        if (buffer->m_clientBuffer) {
+            buffer->m_clientBuffer->unref();
+        }
+        buffer->m_locked = false;
+    }
+    if (!buffer->m_clientBuffer) {
+        delete buffer;
+    }
+}
+
+DrmBuffer *DrmBackend::lockFrontBuffer(gbm_surface *surface)
 {
 #if HAVE_GBM
-    DrmBuffer *b = new DrmBuffer(this, surface);
-    m_buffers << b;
+    gbm_bo *bo = gbm_surface_lock_front_buffer(surface);
+    if (!bo) {
+        qCWarning(KWIN_DRM) << "Locking front buffer failed";
+        return nullptr;
+    }
+    DrmBuffer *b = reinterpret_cast<DrmBuffer*>(gbm_bo_get_user_data(bo));
+    if (!b) {
+        b = new DrmBuffer(this, surface, bo);
+        gbm_bo_set_user_data(bo, b, &DrmBuffer::gbmBufferDestroyed);
+    }
+    b->m_locked = true;
     return b;
 #else
+    Q_UNUSED(surface)
     return nullptr;
 #endif
 }
 
 void DrmBackend::bufferDestroyed(DrmBuffer *b)
 {
-    m_buffers.removeAll(b);
+    if (b->isClientBuffer()) {
+        for (auto it = m_clientBuffers.begin(); it != m_clientBuffers.end(); ++it) {
+            if (it.value() == b) {
+                m_clientBuffers.erase(it);
+                break;
+            }
+        }
+    }
+    for (auto it = m_outputs.constBegin(); it != m_outputs.constEnd(); ++it) {
+        DrmOutput *o = *it;
+        if (o->m_queuedBuffer == b) {
+            o->m_queuedBuffer = nullptr;
+        }
+        if (o->m_scanoutBuffer == b) {
+            o->m_scanoutBuffer = nullptr;
+        }
+    }
 }
 
 DrmOutput::DrmOutput(DrmBackend *backend)
@@ -520,6 +696,16 @@ DrmOutput::~DrmOutput()
 {
     hideCursor();
     cleanupBlackBuffer();
+    DrmBuffer *queued = m_queuedBuffer;
+    DrmBuffer *scanout = m_scanoutBuffer;
+    m_queuedBuffer = nullptr;
+    m_scanoutBuffer = nullptr;
+    if (queued && queued->isClientBuffer()) {
+        m_backend->releaseClientBuffer(queued);
+    }
+    if (scanout && scanout != queued && scanout->isClientBuffer()) {
+        m_backend->releaseClientBuffer(scanout);
+    }
 }
 
 void DrmOutput::hideCursor()
@@ -539,11 +725,20 @@ void DrmOutput::showCursor(DrmBuffer *c)
 {
     const QSize &s = c->size();
     drmModeSetCursor(m_backend->fd(), m_crtcId, c->handle(), s.width(), s.height());
+    m_cursorSize = s;
+    // position is not known to be off this output anymore
+    m_cursorOnOutput = true;
 }
 
 void DrmOutput::moveCursor(const QPoint &globalPos)
 {
     const QPoint p = globalPos - m_globalPos;
+    const bool onOutput = QRect(p, m_cursorSize).intersects(QRect(QPoint(0, 0), size()));
+    if (!onOutput && !m_cursorOnOutput) {
+        // cursor stays outside of this output, the move would not change anything visible
+        return;
+    }
+    m_cursorOnOutput = onOutput;
     drmModeMoveCursor(m_backend->fd(), m_crtcId, p.x(), p.y());
 }
 
@@ -559,39 +754,90 @@ QRect DrmOutput::geometry() const
 
 bool DrmOutput::present(DrmBuffer *buffer)
 {
-    if (!buffer || buffer->bufferId() == 0) {
+    if (!buffer) {
         return false;
     }
-    if (!VirtualTerminal::self()->isActive()) {
-        m_currentBuffer = buffer;
+    if (buffer->bufferId() == 0) {
+        releaseBuffer(buffer);
         return false;
     }
-    if (m_currentBuffer) {
+    if (!VirtualTerminal::self()->isActive() || m_queuedBuffer) {
+        // the frame is dropped, give the buffer back for rendering
+        releaseBuffer(buffer);
         return false;
     }
-    if (m_lastStride != buffer->stride()) {
-        // need to set a new mode first
-        if (!setMode(buffer)) {
-            return false;
+    bool ok = false;
+    if (m_backend->m_planeAssigner) {
+        ok = presentAtomic(buffer);
+    } else {
+        if (m_lastStride != buffer->stride()) {
+            // need to set a new mode first
+            if (!setMode(buffer)) {
+                releaseBuffer(buffer);
+                return false;
+            }
         }
+        ok = drmModePageFlip(m_backend->fd(), m_crtcId, buffer->bufferId(), DRM_MODE_PAGE_FLIP_EVENT, this) == 0;
     }
-    const bool ok = drmModePageFlip(m_backend->fd(), m_crtcId, buffer->bufferId(), DRM_MODE_PAGE_FLIP_EVENT, this) == 0;
     if (ok) {
-        m_currentBuffer = buffer;
+        m_queuedBuffer = buffer;
+        m_pageFlipPending = true;
     } else {
-        qWarning(KWIN_DRM) << "Page flip failed";
-        buffer->releaseGbm();
+        const bool clientBuffer = buffer->isClientBuffer();
+        releaseBuffer(buffer);
+        if (!clientBuffer) {
+            qCWarning(KWIN_DRM) << "Page flip failed";
+            // the scanout buffer stays on screen, so repaint the output with the next frame
+            if (Compositor *compositor = Compositor::self()) {
+                compositor->addRepaint(geometry());
+            }
+        }
     }
     return ok;
 }
 
+bool DrmOutput::presentAtomic(DrmBuffer *buffer)
+{
+    DrmLayer layer;
+    layer.framebuffer = buffer->bufferId();
+    layer.format = buffer->format();
+    layer.size = buffer->size();
+    layer.geometry = QRect(QPoint(0, 0), buffer->size());
+    const QVector<DrmLayer> layers{layer};
+    DrmPlaneAssigner *assigner = m_backend->m_planeAssigner.data();
+    const auto assignment = assigner->assign(m_crtcId, m_crtcIndex, size(), layers);
+    if (!assignment.isValid()) {
+        return false;
+    }
+    if (!m_backend->m_atomicDevice->commit(assignment.request, false, this)) {
+        return false;
+    }
+    assigner->commit(m_crtcId, assignment, layers);
+    return true;
+}
+
+void DrmOutput::releaseBuffer(DrmBuffer *buffer)
+{
+    if (buffer->isClientBuffer()) {
+        m_backend->releaseClientBuffer(buffer);
+    } else {
+        buffer->releaseGbm();
+    }
+}
+
 void DrmOutput::pageFlipped()
 {
-    if (!m_currentBuffer) {
+    m_pageFlipPending = false;
+    if (!m_queuedBuffer) {
         return;
     }
-    m_currentBuffer->releaseGbm();
-    m_currentBuffer = nullptr;
+    // the queued buffer is on screen now, so the previous one can be rendered to again
+    DrmBuffer *previous = m_scanoutBuffer;
+    m_scanoutBuffer = m_queuedBuffer;
+    m_queuedBuffer = nullptr;
+    if (previous && previous != m_scanoutBuffer) {
+        releaseBuffer(previous);
+    }
     cleanupBlackBuffer();
 }
 
@@ -882,44 +1128,56 @@ DrmBuffer::DrmBuffer(DrmBackend *backend, const QSize &size)
     m_handle = createArgs.handle;
     m_bufferSize = createArgs.size;
     m_stride = createArgs.pitch;
+    m_format = DRM_FORMAT_XRGB8888;
     drmModeAddFB(m_backend->fd(), size.width(), size.height(), 24, 32,
                  m_stride, createArgs.handle, &m_bufferId);
 }
 
 
-#if HAVE_GBM
-static void gbmCallback(gbm_bo *bo, void *data)
+DrmBuffer::DrmBuffer(DrmBackend *backend, gbm_surface *surface, gbm_bo *bo)
+    : m_backend(backend)
+    , m_surface(surface)
+    , m_bo(bo)
 {
-    DrmBackend *backend = reinterpret_cast<DrmBackend*>(data);
-    const auto &buffers = backend->buffers();
-    for (auto buffer: buffers) {
-        if (buffer->gbm() == bo) {
-            delete buffer;
-            return;
-        }
+#if HAVE_GBM
+    m_size = QSize(gbm_bo_get_width(m_bo), gbm_bo_get_height(m_bo));
+    m_stride = gbm_bo_get_stride(m_bo);
+    m_format = DRM_FORMAT_XRGB8888;
+    if (drmModeAddFB(m_backend->fd(), m_size.width(), m_size.height(), 24, 32, m_stride, gbm_bo_get_handle(m_bo).u32, &m_bufferId) != 0) {
+        qCWarning(KWIN_DRM) << "drmModeAddFB failed";
     }
-}
 #endif
+}
 
-DrmBuffer::DrmBuffer(DrmBackend *backend, gbm_surface *surface)
+DrmBuffer::DrmBuffer(DrmBackend *backend, gbm_bo *bo, KWayland::Server::BufferInterface *clientBuffer)
     : m_backend(backend)
-    , m_surface(surface)
+    , m_bo(bo)
+    , m_isClientBuffer(true)
+    , m_clientBuffer(clientBuffer)
 {
 #if HAVE_GBM
-    m_bo = gbm_surface_lock_front_buffer(surface);
-    if (!m_bo) {
-        qWarning(KWIN_DRM) << "Locking front buffer failed";
-        return;
-    }
     m_size = QSize(gbm_bo_get_width(m_bo), gbm_bo_get_height(m_bo));
     m_stride = gbm_bo_get_stride(m_bo);
-    if (drmModeAddFB(m_backend->fd(), m_size.width(), m_size.height(), 24, 32, m_stride, gbm_bo_get_handle(m_bo).u32, &m_bufferId) != 0) {
-        qWarning(KWIN_DRM) << "drmModeAddFB failed";
+    m_format = gbm_bo_get_format(m_bo);
+    const uint32_t handles[4] = { gbm_bo_get_handle(m_bo).u32, 0, 0, 0 };
+    const uint32_t pitches[4] = { m_stride, 0, 0, 0 };
+    const uint32_t offsets[4] = { 0, 0, 0, 0 };
+    if (drmModeAddFB2(m_backend->fd(), m_size.width(), m_size.height(), m_format, handles, pitches, offsets, &m_bufferId, 0) != 0) {
+        qCDebug(KWIN_DRM) << "drmModeAddFB2 failed for client buffer";
     }
-    gbm_bo_set_user_data(m_bo, m_backend, gbmCallback);
 #endif
 }
 
+void DrmBuffer::gbmBufferDestroyed(gbm_bo *bo, void *data)
+{
+    Q_UNUSED(bo)
+    DrmBuffer *buffer = reinterpret_cast<DrmBuffer*>(data);
+    // the gbm_bo is already going away together with its gbm_surface
+    buffer->m_locked = false;
+    buffer->m_bo = nullptr;
+    delete buffer;
+}
+
 DrmBuffer::~DrmBuffer()
 {
     m_backend->bufferDestroyed(this);
@@ -935,6 +1193,15 @@ DrmBuffer::~DrmBuffer()
         destroyArgs.handle = m_handle;
         drmIoctl(m_backend->fd(), DRM_IOCTL_MODE_DESTROY_DUMB, &destroyArgs);
     }
+    if (m_isClientBuffer) {
+#if HAVE_GBM
+        gbm_bo_destroy(m_bo);
+#endif
+        if (m_locked && m_clientBuffer) {
+            m_clientBuffer->unref();
+        }
+        return;
+    }
     releaseGbm();
 }
 
@@ -961,9 +1228,9 @@ bool DrmBuffer::map(QImage::Format format)
 void DrmBuffer::releaseGbm()
 {
 #if HAVE_GBM
-    if (m_bo) {
+    if (m_bo && m_locked) {
         gbm_surface_release_buffer(m_surface, m_bo);
-        m_bo = nullptr;
+        m_locked = false;
     }
 #endif
 }
@@ -21,7 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_DRM_BACKEND_H
 #include "abstract_backend.h"
 
+#include <QHash>
 #include <QImage>
+#include <QPointer>
 #include <QSize>
 #include <xf86drmMode.h>
 
@@ -32,6 +34,7 @@ namespace KWayland
 {
 namespace Server
 {
+class BufferInterface;
 class OutputInterface;
 }
 }
@@ -43,7 +46,9 @@ class Udev;
 class UdevMonitor;
 
 class DrmBuffer;
+class DrmDevice;
 class DrmOutput;
+class DrmPlaneAssigner;
 
 class KWIN_EXPORT DrmBackend : public AbstractBackend
 {
@@ -62,8 +67,43 @@ public:
 
     void init() override;
     DrmBuffer *createBuffer(const QSize &size);
-    DrmBuffer *createBuffer(gbm_surface *surface);
-    void present(DrmBuffer *buffer, DrmOutput *output);
+    /**
+     * Locks the front buffer of the @p surface after a buffer swap.
+     *
+     * The DrmBuffer, and with it the framebuffer, is created only once per gbm_bo and kept
+     * in the gbm_bo's user data. As the surface only cycles through a few buffers they are
+     * reused across frames and get destroyed together with the gbm_bo.
+     * The buffer stays locked until released with DrmBuffer::releaseGbm.
+     **/
+    DrmBuffer *lockFrontBuffer(gbm_surface *surface);
+    /**
+     * Creates a DrmBuffer for the @p bo imported from the Wayland @p clientBuffer to scan it out
+     * directly. The DrmBuffer takes over the @p bo.
+     *
+     * Like the buffers of a gbm_surface the DrmBuffer, and with it the framebuffer, is kept for
+     * the @p clientBuffer and returned by findClientBuffer until the client destroys it. While
+     * presented the DrmBuffer keeps a reference on the @p clientBuffer, so that the client does
+     * not reuse it.
+     **/
+    DrmBuffer *createBuffer(gbm_bo *bo, KWayland::Server::BufferInterface *clientBuffer);
+    /**
+     * @returns The DrmBuffer created for the Wayland @p clientBuffer, @c null if there is none.
+     **/
+    DrmBuffer *findClientBuffer(KWayland::Server::BufferInterface *clientBuffer) const {
+        return m_clientBuffers.value(clientBuffer);
+    }
+    /**
+     * Schedules a page flip to @p buffer on @p output.
+     * @returns Whether the page flip got scheduled. If not, the buffer got released.
+     **/
+    bool present(DrmBuffer *buffer, DrmOutput *output);
+    /**
+     * Whether the device is driven through atomic mode setting, enabled by the environment
+     * variable @c KWIN_DRM_AMS. Only then client buffers can be put directly on a plane.
+     **/
+    bool atomicModeSetting() const {
+        return !m_planeAssigner.isNull();
+    }
 
     QSize size() const;
     int fd() const {
@@ -72,40 +112,65 @@ public:
     QVector<DrmOutput*> outputs() const {
         return m_outputs;
     }
-    QVector<DrmBuffer*> buffers() const {
-        return m_buffers;
-    }
     void bufferDestroyed(DrmBuffer *b);
+    /**
+     * Gives the Wayland buffer of the client @p buffer back to the client once no output shows
+     * it any more. The @p buffer gets destroyed if the client already destroyed its buffer.
+     **/
+    void releaseClientBuffer(DrmBuffer *buffer);
 
 Q_SIGNALS:
     void outputRemoved(KWin::DrmOutput *output);
     void outputAdded(KWin::DrmOutput *output);
 
 private:
+    friend class DrmOutput;
     static void pageFlipHandler(int fd, unsigned int frame, unsigned int sec, unsigned int usec, void *data);
     void openDrm();
     void activate(bool active);
     void reactivate();
     void deactivate();
     void queryResources();
-    void setCursor();
+    void setCursor(DrmBuffer *buffer);
     void updateCursor();
+    /**
+     * @returns The cached buffer holding the theme cursor @p image, creates it if the cache is
+     * not full yet. @c null if the image is neither cached nor can be added.
+     **/
+    DrmBuffer *themeCursorBuffer(const QImage &image);
+    void clearCursorCache();
     void hideCursor();
     void moveCursor();
     void initCursor();
     quint32 findCrtc(drmModeRes *res, drmModeConnector *connector, bool *ok = nullptr);
     bool crtcIsUsed(quint32 crtc);
     DrmOutput *findOutput(quint32 connector);
+    /**
+     * Blocks the Compositor if every output is waiting for a page flip, that is no output
+     * could take a new frame.
+     **/
+    void blockCompositorIfBusy();
+    void unblockCompositor();
     QScopedPointer<Udev> m_udev;
     QScopedPointer<UdevMonitor> m_udevMonitor;
     int m_fd = -1;
     int m_drmId = 0;
+    QScopedPointer<DrmDevice> m_atomicDevice;
+    QScopedPointer<DrmPlaneAssigner> m_planeAssigner;
     QVector<DrmOutput*> m_outputs;
+    // the buffers client cursors are painted into alternately
     DrmBuffer *m_cursor[2];
     int m_cursorIndex = 0;
+    // buffers holding theme cursor images, by QImage::cacheKey
+    QHash<qint64, DrmBuffer*> m_cursorCache;
+    DrmBuffer *m_currentCursor = nullptr;
+    // removed from the cache while still being shown, deleted once replaced
+    DrmBuffer *m_staleCursor = nullptr;
+    // the buffers imported from Wayland clients for direct scanout
+    QHash<KWayland::Server::BufferInterface*, DrmBuffer*> m_clientBuffers;
     int m_pageFlipsPending = 0;
+    bool m_compositorBlocked = false;
     bool m_active = false;
-    QVector<DrmBuffer*> m_buffers;
 };
 
 class DrmOutput
@@ -123,6 +188,13 @@ public:
     void moveCursor(const QPoint &globalPos);
     bool present(DrmBuffer *buffer);
     void pageFlipped();
+    /**
+     * Whether a page flip has been scheduled on this output and did not complete yet.
+     * While a page flip is pending the output cannot take a new frame.
+     **/
+    bool isPageFlipPending() const {
+        return m_pageFlipPending;
+    }
     void init(drmModeConnector *connector);
     void restoreSaved();
     void blank();
@@ -135,17 +207,27 @@ private:
     DrmOutput(DrmBackend *backend);
     void cleanupBlackBuffer();
     bool setMode(DrmBuffer *buffer);
+    bool presentAtomic(DrmBuffer *buffer);
+    void releaseBuffer(DrmBuffer *buffer);
     void initEdid(drmModeConnector *connector);
     bool isCurrentMode(const drmModeModeInfo *mode) const;
 
     DrmBackend *m_backend;
     QPoint m_globalPos;
     quint32 m_crtcId = 0;
+    int m_crtcIndex = 0;
     quint32 m_connector = 0;
     quint32 m_lastStride = 0;
     drmModeModeInfo m_mode;
-    DrmBuffer *m_currentBuffer = nullptr;
+    // The swap chain of the output: the queued buffer waits for its page flip, the scanout
+    // buffer is shown on the display. All other buffers of a gbm_surface are free for rendering.
+    DrmBuffer *m_queuedBuffer = nullptr;
+    DrmBuffer *m_scanoutBuffer = nullptr;
     DrmBuffer *m_blackBuffer = nullptr;
+    bool m_pageFlipPending = false;
+    QSize m_cursorSize;
+    // whether the cursor intersected this output at the last move
+    bool m_cursorOnOutput = true;
     struct CrtcCleanup {
         static void inline cleanup(_drmModeCrtc *ptr) {
             drmModeFreeCrtc(ptr);
@@ -177,25 +259,48 @@ public:
     quint32 stride() const {
         return m_stride;
     }
+    /**
+     * @returns The DRM fourcc format of the buffer.
+     **/
+    quint32 format() const {
+        return m_format;
+    }
+    /**
+     * Whether the buffer was imported from a Wayland client for direct scanout. Such buffers
+     * are owned by the DrmBackend and destroyed together with the Wayland buffer.
+     **/
+    bool isClientBuffer() const {
+        return m_isClientBuffer;
+    }
     gbm_bo *gbm() const {
         return m_bo;
     }
+    /**
+     * Releases the gbm_bo back to its gbm_surface, so that it can be used for rendering again.
+     * Does nothing for buffers not locked from a gbm_surface.
+     **/
     void releaseGbm();
 
 private:
     friend class DrmBackend;
     DrmBuffer(DrmBackend *backend, const QSize &size);
-    DrmBuffer(DrmBackend *backend, gbm_surface *surface);
+    DrmBuffer(DrmBackend *backend, gbm_surface *surface, gbm_bo *bo);
+    DrmBuffer(DrmBackend *backend, gbm_bo *bo, KWayland::Server::BufferInterface *clientBuffer);
+    static void gbmBufferDestroyed(gbm_bo *bo, void *data);
     DrmBackend *m_backend;
     gbm_surface *m_surface = nullptr;
     gbm_bo *m_bo = nullptr;
+    bool m_locked = false;
     QSize m_size;
     quint32 m_handle = 0;
     quint32 m_bufferId = 0;
     quint32 m_stride = 0;
+    quint32 m_format = 0;
     quint64 m_bufferSize = 0;
     void *m_memory = nullptr;
     QImage *m_image = nullptr;
+    bool m_isClientBuffer = false;
+    QPointer<KWayland::Server::BufferInterface> m_clientBuffer;
 };
 
 }
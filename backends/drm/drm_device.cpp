@@ -0,0 +1,139 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "drm_device.h"
+#include "logging.h"
+// drm
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+namespace KWin
+{
+
+DrmAtomicDevice::DrmAtomicDevice(int fd)
+    : m_fd(fd)
+{
+}
+
+DrmAtomicDevice::~DrmAtomicDevice() = default;
+
+DrmAtomicDevice *DrmAtomicDevice::create(int fd)
+{
+    if (drmSetClientCap(fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+        qCDebug(KWIN_DRM) << "Atomic mode setting is not supported";
+        return nullptr;
+    }
+    return new DrmAtomicDevice(fd);
+}
+
+QVector<DrmDevice::Plane> DrmAtomicDevice::planes()
+{
+    if (m_planesQueried) {
+        return m_planes;
+    }
+    m_planesQueried = true;
+    drmModePlaneResPtr resources = drmModeGetPlaneResources(m_fd);
+    if (!resources) {
+        qCWarning(KWIN_DRM) << "drmModeGetPlaneResources failed";
+        return m_planes;
+    }
+    for (uint32_t i = 0; i < resources->count_planes; ++i) {
+        drmModePlanePtr p = drmModeGetPlane(m_fd, resources->planes[i]);
+        if (!p) {
+            continue;
+        }
+        Plane plane;
+        plane.id = p->plane_id;
+        plane.possibleCrtcs = p->possible_crtcs;
+        plane.formats.reserve(p->count_formats);
+        for (uint32_t j = 0; j < p->count_formats; ++j) {
+            plane.formats << p->formats[j];
+        }
+        drmModeFreePlane(p);
+
+        drmModeObjectPropertiesPtr properties = drmModeObjectGetProperties(m_fd, plane.id, DRM_MODE_OBJECT_PLANE);
+        if (properties) {
+            for (uint32_t j = 0; j < properties->count_props; ++j) {
+                drmModePropertyPtr property = drmModeGetProperty(m_fd, properties->props[j]);
+                if (!property) {
+                    continue;
+                }
+                if (qstrcmp(property->name, "type") == 0) {
+                    switch (properties->prop_values[j]) {
+                    case DRM_PLANE_TYPE_PRIMARY:
+                        plane.type = PlaneType::Primary;
+                        break;
+                    case DRM_PLANE_TYPE_CURSOR:
+                        plane.type = PlaneType::Cursor;
+                        break;
+                    default:
+                        plane.type = PlaneType::Overlay;
+                        break;
+                    }
+                }
+                drmModeFreeProperty(property);
+            }
+            drmModeFreeObjectProperties(properties);
+        }
+        m_planes << plane;
+    }
+    drmModeFreePlaneResources(resources);
+    return m_planes;
+}
+
+quint32 DrmAtomicDevice::propertyId(quint32 object, const QByteArray &name)
+{
+    if (!m_queriedObjects.contains(object)) {
+        m_queriedObjects << object;
+        drmModeObjectPropertiesPtr properties = drmModeObjectGetProperties(m_fd, object, DRM_MODE_OBJECT_ANY);
+        if (properties) {
+            for (uint32_t i = 0; i < properties->count_props; ++i) {
+                drmModePropertyPtr property = drmModeGetProperty(m_fd, properties->props[i]);
+                if (!property) {
+                    continue;
+                }
+                m_properties.insert(qMakePair(object, QByteArray(property->name)), property->prop_id);
+                drmModeFreeProperty(property);
+            }
+            drmModeFreeObjectProperties(properties);
+        }
+    }
+    return m_properties.value(qMakePair(object, name), 0);
+}
+
+bool DrmAtomicDevice::commit(const DrmAtomicRequest &request, bool testOnly, void *userData)
+{
+    drmModeAtomicReqPtr req = drmModeAtomicAlloc();
+    if (!req) {
+        return false;
+    }
+    const auto &properties = request.properties();
+    for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+        if (drmModeAtomicAddProperty(req, (*it).object, (*it).property, (*it).value) < 0) {
+            drmModeAtomicFree(req);
+            return false;
+        }
+    }
+    const uint32_t flags = testOnly ? DRM_MODE_ATOMIC_TEST_ONLY : (DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK);
+    const bool ok = drmModeAtomicCommit(m_fd, req, flags, userData) == 0;
+    drmModeAtomicFree(req);
+    return ok;
+}
+
+}
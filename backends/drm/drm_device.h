@@ -0,0 +1,138 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_DRM_DEVICE_H
+#define KWIN_DRM_DEVICE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief The property changes of one atomic commit.
+ **/
+class DrmAtomicRequest
+{
+public:
+    struct Property {
+        quint32 object;
+        quint32 property;
+        quint64 value;
+    };
+    void add(quint32 object, quint32 property, quint64 value) {
+        m_properties << Property{object, property, value};
+    }
+    /**
+     * @returns The value the request sets for @p property of @p object, or @p defaultValue if the
+     * request does not change the property.
+     **/
+    quint64 value(quint32 object, quint32 property, quint64 defaultValue = 0) const {
+        for (auto it = m_properties.constBegin(); it != m_properties.constEnd(); ++it) {
+            if ((*it).object == object && (*it).property == property) {
+                return (*it).value;
+            }
+        }
+        return defaultValue;
+    }
+    bool isEmpty() const {
+        return m_properties.isEmpty();
+    }
+    const QVector<Property> &properties() const {
+        return m_properties;
+    }
+
+private:
+    QVector<Property> m_properties;
+};
+
+/**
+ * @brief The calls into a DRM device needed for atomic mode setting.
+ *
+ * The plane assignment only talks to the device through this interface, so that it can be
+ * tested against a fake device without hardware.
+ **/
+class DrmDevice
+{
+public:
+    enum class PlaneType {
+        Overlay,
+        Primary,
+        Cursor
+    };
+    struct Plane {
+        quint32 id = 0;
+        PlaneType type = PlaneType::Overlay;
+        /**
+         * Bit mask of the indices of the crtcs the plane can be used with.
+         **/
+        quint32 possibleCrtcs = 0;
+        /**
+         * The DRM fourcc formats supported by the plane.
+         **/
+        QVector<quint32> formats;
+    };
+    virtual ~DrmDevice() = default;
+
+    virtual QVector<Plane> planes() = 0;
+    /**
+     * @returns The id of the property called @p name of the DRM @p object, @c 0 if the object
+     * does not have such a property.
+     **/
+    virtual quint32 propertyId(quint32 object, const QByteArray &name) = 0;
+    /**
+     * Commits the atomic @p request. If @p testOnly is @c true the kernel only checks whether the
+     * request would succeed without changing the hardware state. Otherwise a page flip event
+     * carrying @p userData is sent once the request got applied.
+     **/
+    virtual bool commit(const DrmAtomicRequest &request, bool testOnly, void *userData = nullptr) = 0;
+};
+
+/**
+ * @brief DrmDevice for a DRM file descriptor supporting atomic mode setting.
+ **/
+class DrmAtomicDevice : public DrmDevice
+{
+public:
+    virtual ~DrmAtomicDevice();
+    /**
+     * Enables atomic mode setting on @p fd.
+     * @returns The DrmAtomicDevice or @c null if the device does not support atomic mode setting.
+     **/
+    static DrmAtomicDevice *create(int fd);
+
+    QVector<Plane> planes() override;
+    quint32 propertyId(quint32 object, const QByteArray &name) override;
+    bool commit(const DrmAtomicRequest &request, bool testOnly, void *userData = nullptr) override;
+
+private:
+    explicit DrmAtomicDevice(int fd);
+    int m_fd;
+    QVector<Plane> m_planes;
+    bool m_planesQueried = false;
+    QHash<QPair<quint32, QByteArray>, quint32> m_properties;
+    QVector<quint32> m_queriedObjects;
+};
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "drm_planes.h"
+#include "logging.h"
+
+namespace KWin
+{
+
+DrmPlaneAssigner::DrmPlaneAssigner(DrmDevice *device)
+    : m_device(device)
+    , m_planes(device->planes())
+{
+}
+
+const DrmDevice::Plane *DrmPlaneAssigner::findPlane(DrmDevice::PlaneType type, quint32 crtcId, int crtcIndex,
+                                                    quint32 format, const QVector<quint32> &used) const
+{
+    for (auto it = m_planes.constBegin(); it != m_planes.constEnd(); ++it) {
+        const DrmDevice::Plane &plane = *it;
+        if (plane.type != type || !(plane.possibleCrtcs & (1 << crtcIndex))) {
+            continue;
+        }
+        if (used.contains(plane.id)) {
+            continue;
+        }
+        const quint32 owner = m_owners.value(plane.id, 0);
+        if (owner != 0 && owner != crtcId) {
+            continue;
+        }
+        if (!plane.formats.contains(format)) {
+            continue;
+        }
+        return &plane;
+    }
+    return nullptr;
+}
+
+void DrmPlaneAssigner::addLayer(DrmAtomicRequest &request, quint32 plane, quint32 crtcId, const DrmLayer &layer)
+{
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("FB_ID")), layer.framebuffer);
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("CRTC_ID")), crtcId);
+    // source coordinates are in 16.16 fixed point
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("SRC_X")), 0);
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("SRC_Y")), 0);
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("SRC_W")), quint64(layer.size.width()) << 16);
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("SRC_H")), quint64(layer.size.height()) << 16);
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("CRTC_X")), layer.geometry.x());
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("CRTC_Y")), layer.geometry.y());
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("CRTC_W")), layer.geometry.width());
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("CRTC_H")), layer.geometry.height());
+}
+
+void DrmPlaneAssigner::disablePlane(DrmAtomicRequest &request, quint32 plane)
+{
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("FB_ID")), 0);
+    request.add(plane, m_device->propertyId(plane, QByteArrayLiteral("CRTC_ID")), 0);
+}
+
+bool DrmPlaneAssigner::isValidated(quint32 crtcId, const QVector<DrmLayer> &layers) const
+{
+    auto it = m_committed.constFind(crtcId);
+    if (it == m_committed.constEnd() || (*it).size() != layers.size()) {
+        return false;
+    }
+    for (int i = 0; i < layers.size(); ++i) {
+        const DrmLayer &a = layers.at(i);
+        const DrmLayer &b = (*it).at(i);
+        if (a.format != b.format || a.size != b.size || a.geometry != b.geometry) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DrmPlaneAssigner::Assignment DrmPlaneAssigner::assign(quint32 crtcId, int crtcIndex, const QSize &outputSize, const QVector<DrmLayer> &layers)
+{
+    if (layers.isEmpty() || layers.first().geometry != QRect(QPoint(0, 0), outputSize)) {
+        // the primary plane has to cover the whole output
+        return Assignment();
+    }
+    QVector<DrmLayer> candidates = layers;
+    while (!candidates.isEmpty()) {
+        Assignment assignment;
+        const DrmDevice::Plane *primary = findPlane(DrmDevice::PlaneType::Primary, crtcId, crtcIndex,
+                                                    candidates.first().format, assignment.planes);
+        if (!primary) {
+            return Assignment();
+        }
+        assignment.planes << primary->id;
+        addLayer(assignment.request, primary->id, crtcId, candidates.first());
+        for (int i = 1; i < candidates.size(); ++i) {
+            const DrmDevice::Plane *overlay = findPlane(DrmDevice::PlaneType::Overlay, crtcId, crtcIndex,
+                                                        candidates.at(i).format, assignment.planes);
+            if (!overlay) {
+                // the remaining layers are above this one, so they have to be composited as well
+                candidates.resize(i);
+                break;
+            }
+            assignment.planes << overlay->id;
+            addLayer(assignment.request, overlay->id, crtcId, candidates.at(i));
+        }
+        for (auto it = m_owners.constBegin(); it != m_owners.constEnd(); ++it) {
+            if (it.value() == crtcId && !assignment.planes.contains(it.key())) {
+                disablePlane(assignment.request, it.key());
+            }
+        }
+        if (isValidated(crtcId, candidates) || m_device->commit(assignment.request, true)) {
+            return assignment;
+        }
+        qCDebug(KWIN_DRM) << "Test commit failed for" << candidates.size() << "planes on crtc" << crtcId;
+        candidates.removeLast();
+    }
+    return Assignment();
+}
+
+void DrmPlaneAssigner::commit(quint32 crtcId, const Assignment &assignment, const QVector<DrmLayer> &layers)
+{
+    release(crtcId);
+    for (auto it = assignment.planes.constBegin(); it != assignment.planes.constEnd(); ++it) {
+        m_owners.insert(*it, crtcId);
+    }
+    m_committed.insert(crtcId, layers.mid(0, assignment.planes.size()));
+}
+
+void DrmPlaneAssigner::release(quint32 crtcId)
+{
+    auto it = m_owners.begin();
+    while (it != m_owners.end()) {
+        if (it.value() == crtcId) {
+            it = m_owners.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_committed.remove(crtcId);
+}
+
+}
@@ -0,0 +1,111 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_DRM_PLANES_H
+#define KWIN_DRM_PLANES_H
+#include "drm_device.h"
+
+#include <QRect>
+#include <QSize>
+
+namespace KWin
+{
+
+/**
+ * @brief A buffer to be shown on an output through a plane.
+ **/
+struct DrmLayer
+{
+    quint32 framebuffer = 0;
+    /**
+     * The DRM fourcc format of the buffer.
+     **/
+    quint32 format = 0;
+    QSize size;
+    /**
+     * The area covered by the buffer in output coordinates.
+     **/
+    QRect geometry;
+};
+
+/**
+ * @brief Assigns buffers to the planes of a DRM device.
+ *
+ * The DrmPlaneAssigner is shared by all outputs of a device and keeps track of which crtc uses
+ * which plane, so that overlay planes usable with several crtcs are not handed out twice.
+ *
+ * Every assignment is validated with a test-only commit. As long as the layers of a crtc keep
+ * their formats, sizes and positions, only the framebuffers change and the validation is skipped.
+ **/
+class DrmPlaneAssigner
+{
+public:
+    explicit DrmPlaneAssigner(DrmDevice *device);
+
+    struct Assignment {
+        /**
+         * The plane for each assigned layer, in the order of the layers.
+         **/
+        QVector<quint32> planes;
+        DrmAtomicRequest request;
+        bool isValid() const {
+            return !planes.isEmpty();
+        }
+    };
+    /**
+     * @brief Assigns the @p layers to the planes of the crtc with @p crtcId and @p crtcIndex.
+     *
+     * The layers are ordered bottom to top. The first layer goes on the primary plane and has to
+     * cover the whole output of @p outputSize, all further layers go on overlay planes. Overlay
+     * planes used by the crtc before, but not needed any more, get disabled.
+     *
+     * If there are not enough planes, or the test-only commit fails, the top most layer is dropped
+     * and the assignment is tried again. Thus the returned Assignment may contain fewer planes than
+     * there are @p layers, the remaining layers have to be composited. If not even the first layer
+     * can be put on the primary plane an invalid Assignment is returned.
+     *
+     * The Assignment is not committed, use commit once the request got applied.
+     **/
+    Assignment assign(quint32 crtcId, int crtcIndex, const QSize &outputSize, const QVector<DrmLayer> &layers);
+    /**
+     * Records that the @p assignment for the crtc with @p crtcId got committed.
+     **/
+    void commit(quint32 crtcId, const Assignment &assignment, const QVector<DrmLayer> &layers);
+    /**
+     * Releases all planes used by the crtc with @p crtcId, e.g. because its output got removed.
+     **/
+    void release(quint32 crtcId);
+
+private:
+    const DrmDevice::Plane *findPlane(DrmDevice::PlaneType type, quint32 crtcId, int crtcIndex,
+                                      quint32 format, const QVector<quint32> &used) const;
+    void addLayer(DrmAtomicRequest &request, quint32 plane, quint32 crtcId, const DrmLayer &layer);
+    void disablePlane(DrmAtomicRequest &request, quint32 plane);
+    bool isValidated(quint32 crtcId, const QVector<DrmLayer> &layers) const;
+    DrmDevice *m_device;
+    QVector<DrmDevice::Plane> m_planes;
+    // plane id to the id of the crtc using it
+    QHash<quint32, quint32> m_owners;
+    // the layer configuration last committed per crtc
+    QHash<quint32, QVector<DrmLayer> > m_committed;
+};
+
+}
+
+#endif
@@ -24,8 +24,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "logging.h"
 #include "options.h"
 #include "screens.h"
+#include "toplevel.h"
 // kwin libs
 #include <kwinglplatform.h>
+// KWayland
+#include <KWayland/Server/buffer_interface.h>
+#include <KWayland/Server/surface_interface.h>
 // Qt
 #include <QOpenGLContext>
 // system
@@ -267,10 +271,7 @@ void EglGbmBackend::present()
 void EglGbmBackend::presentOnOutput(EglGbmBackend::Output &o)
 {
     eglSwapBuffers(eglDisplay(), o.eglSurface);
-    auto oldBuffer = o.buffer;
-    o.buffer = m_backend->createBuffer(o.gbmSurface);
-    m_backend->present(o.buffer, o.output);
-    delete oldBuffer;
+    m_backend->present(m_backend->lockFrontBuffer(o.gbmSurface), o.output);
     if (supportsBufferAge()) {
         eglQuerySurface(eglDisplay(), o.eglSurface, EGL_BUFFER_AGE_EXT, &o.bufferAge);
     }
@@ -323,7 +324,8 @@ void EglGbmBackend::endRenderingFrame(const QRegion &renderedRegion, const QRegi
 void EglGbmBackend::endRenderingFrameForScreen(int screenId, const QRegion &renderedRegion, const QRegion &damagedRegion)
 {
     Output &o = m_outputs[screenId];
-    if (damagedRegion.intersected(o.output->geometry()).isEmpty() && screenId == 0) {
+    const QRect &geometry = o.output->geometry();
+    if (damagedRegion.intersected(geometry).isEmpty()) {
 
         // If the damaged region of a window is fully occluded, the only
         // rendering done, if any, will have been to repair a reused back
@@ -332,30 +334,23 @@ void EglGbmBackend::endRenderingFrameForScreen(int screenId, const QRegion &rend
         // In this case we won't post the back buffer. Instead we'll just
         // set the buffer age to 1, so the repaired regions won't be
         // rendered again in the next frame.
-        if (!renderedRegion.intersected(o.output->geometry()).isEmpty())
+        if (!renderedRegion.intersected(geometry).isEmpty())
             glFlush();
 
-        for (auto &o: m_outputs) {
-            o.bufferAge = 1;
-        }
+        o.bufferAge = 1;
         return;
     }
     presentOnOutput(o);
 
     // Save the damaged region to history
-    // Note: damage history is only collected for the first screen. For any other screen full repaints
-    // are triggered. This is due to a limitation in Scene::paintGenericScreen which resets the Toplevel's
-    // repaint. So multiple calls to Scene::paintScreen as it's done in multi-output rendering only
-    // have correct damage information for the first screen. If we try to track damage nevertheless,
-    // it creates artifacts. So for the time being we work around the problem by only supporting buffer
-    // age on the first output. To properly support buffer age on all outputs the rendering needs to
-    // be refactored in general.
-    if (supportsBufferAge() && screenId == 0) {
+    // The Scene passes the window repaints of the whole frame to each screen, so the damage
+    // is complete for every output and buffer age can be used on all of them.
+    if (supportsBufferAge()) {
         if (o.damageHistory.count() > 10) {
             o.damageHistory.removeLast();
         }
 
-        o.damageHistory.prepend(damagedRegion.intersected(o.output->geometry()));
+        o.damageHistory.prepend(damagedRegion.intersected(geometry));
     }
 }
 
@@ -369,6 +364,40 @@ bool EglGbmBackend::perScreenRendering() const
     return true;
 }
 
+bool EglGbmBackend::isScreenBusy(int screenId) const
+{
+    return m_outputs.at(screenId).output->isPageFlipPending();
+}
+
+bool EglGbmBackend::directScanout(int screenId, Toplevel *toplevel)
+{
+    if (!m_backend->atomicModeSetting()) {
+        return false;
+    }
+    Output &o = m_outputs[screenId];
+    KWayland::Server::BufferInterface *buffer = toplevel->surface()->buffer();
+    if (!buffer || buffer->shmBuffer() || !buffer->resource() || buffer->size() != o.output->size()) {
+        return false;
+    }
+    // the framebuffer is created once per client buffer, clients cycle through a few buffers
+    DrmBuffer *b = m_backend->findClientBuffer(buffer);
+    if (!b) {
+        gbm_bo *bo = gbm_bo_import(m_device, GBM_BO_IMPORT_WL_BUFFER, buffer->resource(), GBM_BO_USE_SCANOUT);
+        if (!bo) {
+            return false;
+        }
+        b = m_backend->createBuffer(bo, buffer);
+    }
+    // the plane assignment validates the buffer, if it cannot be scanned out the screen gets composited
+    if (!m_backend->present(b, o.output)) {
+        return false;
+    }
+    // the back buffers of the gbm surface missed the updates while the client buffer was shown
+    o.damageHistory.clear();
+    o.bufferAge = 0;
+    return true;
+}
+
 /************************************************
  * EglTexture
  ************************************************/
@@ -28,7 +28,6 @@ struct gbm_surface;
 namespace KWin
 {
 class DrmBackend;
-class DrmBuffer;
 class DrmOutput;
 
 /**
@@ -48,6 +47,8 @@ public:
     bool usesOverlayWindow() const override;
     bool perScreenRendering() const override;
     QRegion prepareRenderingForScreen(int screenId) override;
+    bool isScreenBusy(int screenId) const override;
+    bool directScanout(int screenId, Toplevel *toplevel) override;
 
 protected:
     void present() override;
@@ -60,7 +61,6 @@ private:
     bool initRenderingContext();
     struct Output {
         DrmOutput *output = nullptr;
-        DrmBuffer *buffer = nullptr;
         gbm_surface *gbmSurface = nullptr;
         EGLSurface eglSurface = EGL_NO_SURFACE;
         int bufferAge = 0;
@@ -20,6 +20,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "scene_qpainter_drm_backend.h"
 #include "drm_backend.h"
 #include "virtual_terminal.h"
+// Qt
+#include <QPainter>
+// drm
+#include <xf86drmMode.h>
+// system
+#include <errno.h>
 
 namespace KWin
 {
@@ -69,6 +75,8 @@ void DrmQPainterBackend::initOutput(DrmOutput *output)
     };
     initBuffer(0);
     initBuffer(1);
+    o.image = QImage(output->size(), QImage::Format_RGB32);
+    o.image.fill(Qt::black);
     o.output = output;
     m_outputs << o;
 }
@@ -80,32 +88,88 @@ QImage *DrmQPainterBackend::buffer()
 
 QImage *DrmQPainterBackend::bufferForScreen(int screenId)
 {
-    const Output &o = m_outputs.at(screenId);
-    return o.buffer[o.index]->image();
+    return &m_outputs[screenId].image;
 }
 
 bool DrmQPainterBackend::needsFullRepaint() const
 {
-    return true;
+    return false;
 }
 
 void DrmQPainterBackend::prepareRenderingFrame()
 {
-    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
-        (*it).index = ((*it).index + 1) % 2;
-    }
+}
+
+void DrmQPainterBackend::prepareRenderingForScreen(int screenId)
+{
+    Output &o = m_outputs[screenId];
+    o.index = (o.index + 1) % 2;
+    o.needsPresent = true;
+}
+
+bool DrmQPainterBackend::isScreenBusy(int screenId) const
+{
+    return m_outputs.at(screenId).output->isPageFlipPending();
 }
 
 void DrmQPainterBackend::present(int mask, const QRegion &damage)
 {
     Q_UNUSED(mask)
-    Q_UNUSED(damage)
-    if (!VirtualTerminal::self()->isActive()) {
+    const bool active = VirtualTerminal::self()->isActive();
+    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+        Output &o = *it;
+        if (!o.needsPresent) {
+            continue;
+        }
+        o.needsPresent = false;
+        // damage is in global coordinates
+        const QRect geometry = o.output->geometry();
+        const QRegion outputDamage = damage.intersected(geometry).translated(-geometry.topLeft());
+        o.damage[0] |= outputDamage;
+        o.damage[1] |= outputDamage;
+        if (!active) {
+            // the buffers catch up once presenting again
+            continue;
+        }
+        // the buffer still misses everything rendered since it got presented last time
+        DrmBuffer *buffer = o.buffer[o.index];
+        QRegion &bufferDamage = o.damage[o.index];
+        if (!bufferDamage.isEmpty()) {
+            QPainter p(buffer->image());
+            p.setCompositionMode(QPainter::CompositionMode_Source);
+            const auto rects = bufferDamage.rects();
+            for (const QRect &rect : rects) {
+                p.drawImage(rect, o.image, rect);
+            }
+            p.end();
+            markDirty(buffer, bufferDamage);
+            bufferDamage = QRegion();
+        }
+        m_backend->present(buffer, o.output);
+    }
+}
+
+void DrmQPainterBackend::markDirty(DrmBuffer *buffer, const QRegion &region)
+{
+    // drivers for displays without continuous scan out, e.g. USB displays, only transfer the areas
+    // marked as dirty
+    if (!m_dirtyFbSupported) {
         return;
     }
-    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
-        const Output &o = *it;
-        m_backend->present(o.buffer[o.index], o.output);
+    const auto rects = region.rects();
+    QVector<drmModeClip> clips;
+    clips.reserve(rects.count());
+    for (const QRect &rect : rects) {
+        drmModeClip clip;
+        clip.x1 = rect.x();
+        clip.y1 = rect.y();
+        clip.x2 = rect.x() + rect.width();
+        clip.y2 = rect.y() + rect.height();
+        clips << clip;
+    }
+    if (drmModeDirtyFB(m_backend->fd(), buffer->bufferId(), clips.data(), clips.count()) == -ENOSYS) {
+        // the driver scans out continuously, no need to tell it again
+        m_dirtyFbSupported = false;
     }
 }
 
@@ -43,16 +43,31 @@ public:
     void prepareRenderingFrame() override;
     void present(int mask, const QRegion &damage) override;
     bool perScreenRendering() const override;
+    void prepareRenderingForScreen(int screenId) override;
+    bool isScreenBusy(int screenId) const override;
 
 private:
     void initOutput(DrmOutput *output);
+    void markDirty(DrmBuffer *buffer, const QRegion &region);
     struct Output {
         DrmBuffer *buffer[2];
         DrmOutput *output;
         int index = 0;
+        bool needsPresent = false;
+        /**
+         * The scene renders into this image in system memory. Reading back from the write-combined
+         * dumb buffers while blending would be slow, and the image keeps the content of the last
+         * frame so that only the damaged areas need to be rendered.
+         **/
+        QImage image;
+        /**
+         * For each buffer the area in which it differs from image, in output coordinates.
+         **/
+        QRegion damage[2];
     };
     QVector<Output> m_outputs;
     DrmBackend *m_backend;
+    bool m_dirtyFbSupported = true;
 };
 }
 
@@ -74,12 +74,20 @@ void FramebufferQPainterBackend::prepareRenderingFrame()
 void FramebufferQPainterBackend::present(int mask, const QRegion &damage)
 {
     Q_UNUSED(mask)
-    Q_UNUSED(damage)
+    const QRect cursorRect = m_cursorRect;
+    m_cursorRect = QRect();
     if (!VirtualTerminal::self()->isActive()) {
         return;
     }
+    // the render buffer keeps the previous frame, so only the updated areas need to be copied
+    // into the framebuffer's uncached memory
+    const QRegion updated = (damage | cursorRect) & m_renderBuffer.rect();
     QPainter p(&m_backBuffer);
-    p.drawImage(QPoint(0, 0), m_renderBuffer);
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    const auto rects = updated.rects();
+    for (const QRect &rect : rects) {
+        p.drawImage(rect, m_renderBuffer, rect);
+    }
 }
 
 bool FramebufferQPainterBackend::usesOverlayWindow() const
@@ -99,6 +107,7 @@ void FramebufferQPainterBackend::renderCursor(QPainter *painter)
     const QPoint cursorPos = Cursor::pos();
     const QPoint hotspot = m_backend->softwareCursorHotspot();
     painter->drawImage(cursorPos - hotspot, img);
+    m_cursorRect = QRect(cursorPos - hotspot, img.size());
     m_backend->markCursorAsRendered();
 }
 
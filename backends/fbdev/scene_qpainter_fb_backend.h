@@ -45,6 +45,8 @@ private:
     QImage m_renderBuffer;
     QImage m_backBuffer;
     FramebufferBackend *m_backend;
+    // where the software cursor got rendered in the current frame, not part of the scene's damage
+    QRect m_cursorRect;
 };
 
 }
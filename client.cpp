@@ -139,6 +139,7 @@ Client::Client()
     syncRequest.timeout = syncRequest.failsafeTimeout = NULL;
     syncRequest.lastTimestamp = xTime();
     syncRequest.isPending = false;
+    syncRequest.hasPendingMotion = false;
 
     // Set the initial mapping state
     mapping_state = Withdrawn;
@@ -1783,12 +1784,27 @@ void Client::getIcons()
 }
 
 void Client::getSyncCounter()
+{
+    auto property = fetchSyncCounter();
+    readSyncCounter(property);
+}
+
+Xcb::Property Client::fetchSyncCounter() const
+{
+#if HAVE_XCB_SYNC
+    if (Xcb::Extensions::self()->isSyncAvailable()) {
+        return Xcb::Property(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
+    }
+#endif
+    return Xcb::Property();
+}
+
+void Client::readSyncCounter(Xcb::Property &syncProp)
 {
 #if HAVE_XCB_SYNC
     if (!Xcb::Extensions::self()->isSyncAvailable())
         return;
 
-    Xcb::Property syncProp(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
     const xcb_sync_counter_t counter = syncProp.value<xcb_sync_counter_t>(XCB_NONE);
     if (counter != XCB_NONE) {
         syncRequest.counter = counter;
@@ -1820,6 +1836,8 @@ void Client::getSyncCounter()
             }
         }
     }
+#else
+    Q_UNUSED(syncProp)
 #endif
 }
 
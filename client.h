@@ -257,6 +257,11 @@ public:
     NET::WindowType windowType(bool direct = false, int supported_types = 0) const;
 
     bool manage(xcb_window_t w, bool isMapped);
+    /**
+     * Same as manage(xcb_window_t, bool), but uses the already requested @p attr and
+     * @p windowGeometry, so that the requests for several windows can be pipelined.
+     **/
+    bool manage(xcb_window_t w, bool isMapped, Xcb::WindowAttributes &attr, Xcb::WindowGeometry &windowGeometry);
     void releaseWindow(bool on_shutdown = false);
     void destroyClient();
 
@@ -581,6 +586,7 @@ protected:
 private Q_SLOTS:
     void delayedSetShortcut();
     void performMoveResize();
+    void performPendingMoveResize();
 
     //Signals for the scripting interface
     //Signals make an excellent way for communication
@@ -665,6 +671,8 @@ private:
     int checkShadeGeometry(int w, int h);
     void blockGeometryUpdates(bool block);
     void getSyncCounter();
+    Xcb::Property fetchSyncCounter() const;
+    void readSyncCounter(Xcb::Property &property);
     void sendSyncRequest();
     bool startMoveResize();
     void finishMoveResize(bool cancel);
@@ -829,6 +837,10 @@ private:
         xcb_timestamp_t lastTimestamp;
         QTimer *timeout, *failsafeTimeout;
         bool isPending;
+        // latest pointer motion which arrived while waiting for the client,
+        // applied as soon as the client caught up
+        bool hasPendingMotion;
+        QPoint pendingMotion, pendingMotionRoot;
     } syncRequest;
     static bool check_active_modal; ///< \see Client::checkActiveModal()
     QKeySequence _shortcut;
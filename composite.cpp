@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "scene_qpainter.h"
 #include "screens.h"
 #include "shadow.h"
+#include "startuptrace.h"
 #include "useractions.h"
 #include "compositingprefs.h"
 #include "xcbutils.h"
@@ -179,6 +180,7 @@ void Compositor::setup()
         return;
     }
     m_starting = true;
+    StartupTrace::begin(QStringLiteral("Compositor until first frame"));
 
     if (!options->isCompositingInitialized()) {
         options->reloadCompositingSettings(true);
@@ -202,6 +204,7 @@ void Compositor::slotCompositingOptionsInitialized()
         }
     }
 
+    StartupTrace::begin(QStringLiteral("Scene creation"));
     switch(options->compositingMode()) {
     case OpenGLCompositing: {
         qCDebug(KWIN_CORE) << "Initializing OpenGL compositing";
@@ -265,6 +268,7 @@ void Compositor::slotCompositingOptionsInitialized()
         }
         return;
     }
+    StartupTrace::end(QStringLiteral("Scene creation"));
     if (m_scene == NULL || m_scene->initFailed()) {
         qCCritical(KWIN_CORE) << "Failed to initialize compositing, compositing disabled";
         delete m_scene;
@@ -324,7 +328,10 @@ void Compositor::startupWithWorkspace()
     m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now" - we don't have even a slight idea when the first vsync will occur
     scheduleRepaint();
     xcb_composite_redirect_subwindows(connection(), rootWindow(), XCB_COMPOSITE_REDIRECT_MANUAL);
-    new EffectsHandlerImpl(this, m_scene);   // sets also the 'effects' pointer
+    {
+        StartupTrace::Scope trace(QStringLiteral("Effects handler"));
+        new EffectsHandlerImpl(this, m_scene);   // sets also the 'effects' pointer
+    }
     connect(effects, SIGNAL(screenGeometryChanged(QSize)), SLOT(addRepaintFull()));
     addRepaintFull();
     foreach (Client * c, Workspace::self()->clientList()) {
@@ -347,6 +354,7 @@ void Compositor::startupWithWorkspace()
 
     // render at least once
     performCompositing();
+    StartupTrace::end(QStringLiteral("Compositor until first frame"));
 }
 
 void Compositor::scheduleRepaint()
@@ -630,6 +638,23 @@ void Compositor::bufferSwapComplete()
     }
 }
 
+void Compositor::screenFrameCompleted(const QRect &geometry)
+{
+    if (!hasScene()) {
+        return;
+    }
+    // damage the scene could not paint while the screen was busy, added without
+    // going through addRepaint as the frame is started right away
+    repaints_region |= m_scene->takeDeferredRepaints(geometry);
+    if (!Workspace::self() || m_bufferSwapPending) {
+        return;
+    }
+    if (!repaints_region.intersects(geometry) && !windowRepaintsPending(geometry)) {
+        return;
+    }
+    performCompositing();
+}
+
 void Compositor::performCompositing()
 {
     if (m_scene->usesOverlayWindow() && !isOverlayWindowVisible())
@@ -730,25 +755,29 @@ void Compositor::performCompositing()
     }
 }
 
-bool Compositor::windowRepaintsPending() const
+bool Compositor::windowRepaintsPending(const QRect &area) const
 {
+    auto hasRepaints = [&area] (Toplevel *c) {
+        const QRegion repaints = c->repaints();
+        return area.isNull() ? !repaints.isEmpty() : repaints.intersects(area);
+    };
     foreach (Toplevel * c, Workspace::self()->clientList())
-    if (!c->repaints().isEmpty())
+    if (hasRepaints(c))
         return true;
     foreach (Toplevel * c, Workspace::self()->desktopList())
-    if (!c->repaints().isEmpty())
+    if (hasRepaints(c))
         return true;
     foreach (Toplevel * c, Workspace::self()->unmanagedList())
-    if (!c->repaints().isEmpty())
+    if (hasRepaints(c))
         return true;
     foreach (Toplevel * c, Workspace::self()->deletedList())
-    if (!c->repaints().isEmpty())
+    if (hasRepaints(c))
         return true;
 #if HAVE_WAYLAND
     if (auto w = waylandServer()) {
         const auto &clients = w->clients();
         for (auto c : clients) {
-            if (!c->repaints().isEmpty()) {
+            if (hasRepaints(c)) {
                 return true;
             }
         }
@@ -68,6 +68,12 @@ public:
     int xrrRefreshRate() const {
         return m_xrrRefreshRate;
     }
+    /**
+     * @returns The interval in nanoseconds between two frames rendered by the Compositor.
+     **/
+    qint64 frameInterval() const {
+        return fpsInterval;
+    }
     void setCompositeResetTimer(int msecs);
 
     bool hasScene() const {
@@ -183,6 +189,17 @@ public Q_SLOTS:
      */
     void bufferSwapComplete();
 
+    /**
+     * Notifies the compositor that the screen with the given @p geometry presented its frame
+     * and can take the next one. Used by backends driving each screen by its own frame clock.
+     *
+     * If there are repaints pending for the screen the next frame is rendered right away
+     * instead of waiting for the composite timer, so that each screen is updated at its
+     * own refresh rate. This includes the repaints the Scene deferred while the screen
+     * was busy, see Scene::takeDeferredRepaints.
+     */
+    void screenFrameCompleted(const QRect &geometry);
+
 Q_SIGNALS:
     void compositingToggled(bool active);
     void aboutToDestroy();
@@ -212,7 +229,7 @@ private Q_SLOTS:
 private:
     void claimCompositorSelection();
     void setCompositeTimer();
-    bool windowRepaintsPending() const;
+    bool windowRepaintsPending(const QRect &area = QRect()) const;
     /**
      * Continues the startup after Scene And Workspace are created
      **/
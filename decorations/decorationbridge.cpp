@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "client.h"
 #include "composite.h"
 #include "scene.h"
+#include "startuptrace.h"
 #include "workspace.h"
 
 // KDecoration
@@ -37,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KPluginLoader>
 
 // Qt
+#include <QtConcurrentRun>
 #include <QDebug>
 #include <QMetaProperty>
 #include <QPainter>
@@ -74,6 +76,24 @@ QString DecorationBridge::readTheme() const
     return KSharedConfig::openConfig(KWIN_CONFIG)->group(s_pluginName).readEntry("theme", m_defaultTheme);
 }
 
+QFuture<void> DecorationBridge::preloadPlugin()
+{
+    // the config is not thread safe, read it here
+    const QString plugin = readPlugin();
+    return QtConcurrent::run([plugin] {
+        StartupTrace::Scope trace(QStringLiteral("Loading decoration plugin"));
+        const auto offers = KPluginTrader::self()->query(s_pluginName,
+                                                         s_pluginName,
+                                                         QStringLiteral("[X-KDE-PluginInfo-Name] == '%1'").arg(plugin));
+        if (offers.isEmpty()) {
+            return;
+        }
+        // only load the library, the factory has to be created in the main thread
+        KPluginLoader loader(offers.first().libraryPath());
+        loader.load();
+    });
+}
+
 void DecorationBridge::init()
 {
     m_plugin = readPlugin();
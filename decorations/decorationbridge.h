@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <KDecoration2/Private/DecorationBridge>
 
+#include <QFuture>
 #include <QObject>
 #include <QSharedPointer>
 
@@ -48,6 +49,11 @@ class DecorationBridge : public KDecoration2::DecorationBridge
 public:
     virtual ~DecorationBridge();
 
+    /**
+     * Loads the library of the configured decoration plugin in a thread, so that init only needs
+     * to create the factory. Has to be called from the main thread before the bridge gets created.
+     **/
+    static QFuture<void> preloadPlugin();
     void init();
     KDecoration2::Decoration *createDecoration(Client *client);
 
@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <config-kwin.h>
 #include <kwineffects.h>
 #include "effects/effect_builtins.h"
+#include "scripting/scriptcache.h"
 #include "scripting/scriptedeffect.h"
 #include "utils.h"
 // KDE
@@ -32,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QtConcurrentRun>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QMap>
 #include <QStringList>
@@ -137,6 +139,8 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
     if (m_loadedEffects.contains(effect)) {
         return false;
     }
+    QElapsedTimer timer;
+    timer.start();
 
     // supported might need a context
 #ifndef KWIN_UNIT_TEST
@@ -167,7 +171,7 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
             m_loadedEffects.remove(effect);
         }
     );
-    qCDebug(KWIN_CORE) << "Successfully loaded built-in effect: " << name;
+    qCDebug(KWIN_CORE) << "Successfully loaded built-in effect: " << name << "in" << timer.elapsed() << "ms";
     emit effectLoaded(e, name);
     return true;
 }
@@ -232,6 +236,8 @@ bool ScriptedEffectLoader::loadEffect(KService::Ptr effect, LoadEffectFlags flag
         qCDebug(KWIN_CORE) << name << "already loaded";
         return false;
     }
+    QElapsedTimer timer;
+    timer.start();
 
     ScriptedEffect *e = ScriptedEffect::create(effect);
     if (!e) {
@@ -244,7 +250,7 @@ bool ScriptedEffectLoader::loadEffect(KService::Ptr effect, LoadEffectFlags flag
         }
     );
 
-    qCDebug(KWIN_CORE) << "Successfully loaded scripted effect: " << name;
+    qCDebug(KWIN_CORE) << "Successfully loaded scripted effect: " << name << "in" << timer.elapsed() << "ms";
     emit effectLoaded(e, name);
     m_loadedEffects << name;
     return true;
@@ -267,7 +273,21 @@ void ScriptedEffectLoader::queryAndLoadAll()
             watcher->deleteLater();
         },
         Qt::QueuedConnection);
-    watcher->setFuture(QtConcurrent::run(this, &ScriptedEffectLoader::findAllEffects));
+    watcher->setFuture(QtConcurrent::run(
+        [this]() {
+            const KService::List effects = findAllEffects();
+            // read the scripts while still in the thread, loading the effects hits the cache
+            QStringList scripts;
+            for (KService::Ptr effect : effects) {
+                const QString script = ScriptedEffect::locateScript(effect);
+                if (!script.isNull()) {
+                    scripts << script;
+                }
+            }
+            ScriptCache::preload(scripts);
+            return effects;
+        }
+    ));
 }
 
 KService::List ScriptedEffectLoader::findAllEffects() const
@@ -374,6 +394,8 @@ bool PluginEffectLoader::loadEffect(const KPluginInfo &info, LoadEffectFlags fla
         qCDebug(KWIN_CORE) << name << " already loaded";
         return false;
     }
+    QElapsedTimer timer;
+    timer.start();
     EffectPluginFactory *effectFactory = factory(info);
     if (!effectFactory) {
         qCDebug(KWIN_CORE) << "Couldn't get an EffectPluginFactory for: " << name;
@@ -408,7 +430,7 @@ bool PluginEffectLoader::loadEffect(const KPluginInfo &info, LoadEffectFlags fla
             m_loadedEffects.removeAll(name);
         }
     );
-    qCDebug(KWIN_CORE) << "Successfully loaded plugin effect: " << name;
+    qCDebug(KWIN_CORE) << "Successfully loaded plugin effect: " << name << "in" << timer.elapsed() << "ms";
     emit effectLoaded(e, name);
     return true;
 }
@@ -420,18 +442,48 @@ void PluginEffectLoader::queryAndLoadAll()
     connect(watcher, &QFutureWatcher<KPluginInfo::List>::finished, this,
         [this, watcher]() {
             const KPluginInfo::List effects = watcher->result();
+            watcher->deleteLater();
+            QList<QPair<KPluginInfo, LoadEffectFlags>> toLoad;
+            QStringList libraries;
             for (const KPluginInfo &effect : effects) {
                 const LoadEffectFlags flags = readConfig(effect.pluginName(), effect.isPluginEnabledByDefault());
                 if (flags.testFlag(LoadEffectFlag::Load)) {
-                    m_queue->enqueue(qMakePair(effect, flags));
+                    toLoad << qMakePair(effect, flags);
+                    libraries << effect.libraryPath();
                 }
             }
-            watcher->deleteLater();
+            if (toLoad.isEmpty()) {
+                return;
+            }
+            // load the libraries in a thread as well, the factories and effects get created in
+            // the compositor thread once the queue loads the effects
+            QFutureWatcher<void> *libraryWatcher = new QFutureWatcher<void>(this);
+            connect(libraryWatcher, &QFutureWatcher<void>::finished, this,
+                [this, libraryWatcher, toLoad]() {
+                    for (auto it = toLoad.constBegin(); it != toLoad.constEnd(); ++it) {
+                        m_queue->enqueue(*it);
+                    }
+                    libraryWatcher->deleteLater();
+                },
+                Qt::QueuedConnection);
+            libraryWatcher->setFuture(QtConcurrent::run(&PluginEffectLoader::loadLibraries, libraries));
         },
         Qt::QueuedConnection);
     watcher->setFuture(QtConcurrent::run(this, &PluginEffectLoader::findAllEffects));
 }
 
+void PluginEffectLoader::loadLibraries(const QStringList &libraries)
+{
+    for (auto it = libraries.constBegin(); it != libraries.constEnd(); ++it) {
+        // the library stays loaded after the loader is gone, only the instance must not be
+        // created in this thread
+        KPluginLoader loader(*it);
+        if (!loader.load()) {
+            qCDebug(KWIN_CORE) << "Failed to load library" << *it << loader.errorString();
+        }
+    }
+}
+
 KPluginInfo::List PluginEffectLoader::findAllEffects() const
 {
     return KPluginTrader::self()->query(m_pluginSubDirectory, s_serviceType);
@@ -334,6 +334,7 @@ private:
     QList<KPluginInfo> findAllEffects() const;
     KPluginInfo findEffect(const QString &name) const;
     EffectPluginFactory *factory(const KPluginInfo &info) const;
+    static void loadLibraries(const QStringList &libraries);
     QStringList m_loadedEffects;
     EffectLoadQueue< PluginEffectLoader, KPluginInfo> *m_queue;
     QString m_pluginSubDirectory;
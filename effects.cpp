@@ -1042,6 +1042,18 @@ EffectWindowList EffectsHandlerImpl::stackingOrder() const
     return ret;
 }
 
+EffectWindowList EffectsHandlerImpl::stackingOrderOnDesktop(int desktop) const
+{
+    const ToplevelList &list = Workspace::self()->stackingOrderOnDesktop(desktop);
+    EffectWindowList ret;
+    ret.reserve(list.count());
+    for (Toplevel *t : list) {
+        if (EffectWindow *w = effectWindow(t))
+            ret.append(w);
+    }
+    return ret;
+}
+
 void EffectsHandlerImpl::setElevatedWindow(KWin::EffectWindow* w, bool set)
 {
     elevated_windows.removeAll(w);
@@ -125,6 +125,7 @@ public:
     void stopMousePolling() override;
     EffectWindow* findWindow(WId id) const override;
     EffectWindowList stackingOrder() const override;
+    EffectWindowList stackingOrderOnDesktop(int desktop) const override;
     void setElevatedWindow(KWin::EffectWindow* w, bool set) override;
 
     void setTabBoxWindow(EffectWindow*) override;
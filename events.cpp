@@ -292,7 +292,7 @@ bool Workspace::workspaceEvent(xcb_generic_event_t *e)
         const QPoint rootPos(mouseEvent->root_x, mouseEvent->root_y);
 #ifdef KWIN_BUILD_TABBOX
         if (TabBox::TabBox::self()->isGrabbed()) {
-            ScreenEdges::self()->check(rootPos, QDateTime::fromMSecsSinceEpoch(xTime()), true);
+            ScreenEdges::self()->check(rootPos, true);
             return TabBox::TabBox::self()->handleMouseEvent(mouseEvent);
         }
 #endif
@@ -300,9 +300,9 @@ bool Workspace::workspaceEvent(xcb_generic_event_t *e)
             return true;
         }
         if (QWidget::mouseGrabber()) {
-            ScreenEdges::self()->check(rootPos, QDateTime::fromMSecsSinceEpoch(xTime()), true);
+            ScreenEdges::self()->check(rootPos, true);
         } else {
-            ScreenEdges::self()->check(rootPos, QDateTime::fromMSecsSinceEpoch(mouseEvent->time));
+            ScreenEdges::self()->check(rootPos);
         }
         break;
     }
@@ -26,6 +26,141 @@ namespace KWin
 
 KWIN_SINGLETON_FACTORY_VARIABLE(FocusChain, s_manager)
 
+bool FocusChain::Chain::contains(AbstractClient *client) const
+{
+    return m_links.contains(client);
+}
+
+bool FocusChain::Chain::isEmpty() const
+{
+    return m_links.isEmpty();
+}
+
+int FocusChain::Chain::size() const
+{
+    return m_links.size();
+}
+
+AbstractClient *FocusChain::Chain::first() const
+{
+    return m_first;
+}
+
+AbstractClient *FocusChain::Chain::last() const
+{
+    return m_last;
+}
+
+AbstractClient *FocusChain::Chain::previous(AbstractClient *client) const
+{
+    auto it = m_links.constFind(client);
+    if (it == m_links.constEnd()) {
+        return nullptr;
+    }
+    return it.value().previous;
+}
+
+AbstractClient *FocusChain::Chain::next(AbstractClient *client) const
+{
+    auto it = m_links.constFind(client);
+    if (it == m_links.constEnd()) {
+        return nullptr;
+    }
+    return it.value().next;
+}
+
+void FocusChain::Chain::append(AbstractClient *client)
+{
+    remove(client);
+    Link link;
+    link.previous = m_last;
+    if (m_last) {
+        m_links[m_last].next = client;
+    } else {
+        m_first = client;
+    }
+    m_last = client;
+    m_links.insert(client, link);
+}
+
+void FocusChain::Chain::prepend(AbstractClient *client)
+{
+    remove(client);
+    Link link;
+    link.next = m_first;
+    if (m_first) {
+        m_links[m_first].previous = client;
+    } else {
+        m_last = client;
+    }
+    m_first = client;
+    m_links.insert(client, link);
+}
+
+void FocusChain::Chain::insertBefore(AbstractClient *client, AbstractClient *reference)
+{
+    if (client == reference) {
+        return;
+    }
+    remove(client);
+    auto it = m_links.find(reference);
+    if (it == m_links.end()) {
+        return;
+    }
+    Link link;
+    link.previous = it.value().previous;
+    link.next = reference;
+    it.value().previous = client;
+    if (link.previous) {
+        m_links[link.previous].next = client;
+    } else {
+        m_first = client;
+    }
+    m_links.insert(client, link);
+}
+
+void FocusChain::Chain::insertAfter(AbstractClient *client, AbstractClient *reference)
+{
+    if (client == reference) {
+        return;
+    }
+    remove(client);
+    auto it = m_links.find(reference);
+    if (it == m_links.end()) {
+        return;
+    }
+    Link link;
+    link.previous = reference;
+    link.next = it.value().next;
+    it.value().next = client;
+    if (link.next) {
+        m_links[link.next].previous = client;
+    } else {
+        m_last = client;
+    }
+    m_links.insert(client, link);
+}
+
+void FocusChain::Chain::remove(AbstractClient *client)
+{
+    auto it = m_links.find(client);
+    if (it == m_links.end()) {
+        return;
+    }
+    const Link link = it.value();
+    m_links.erase(it);
+    if (link.previous) {
+        m_links[link.previous].next = link.next;
+    } else {
+        m_first = link.next;
+    }
+    if (link.next) {
+        m_links[link.next].previous = link.previous;
+    } else {
+        m_last = link.previous;
+    }
+}
+
 FocusChain::FocusChain(QObject *parent)
     : QObject(parent)
     , m_separateScreenFocus(false)
@@ -44,18 +179,32 @@ void FocusChain::remove(AbstractClient *client)
     for (DesktopChains::iterator it = m_desktopFocusChains.begin();
             it != m_desktopFocusChains.end();
             ++it) {
-        it.value().removeAll(client);
+        it.value().remove(client);
+    }
+    for (ScreenChains::iterator it = m_screenFocusChains.begin();
+            it != m_screenFocusChains.end();
+            ++it) {
+        for (auto screenIt = it.value().begin(); screenIt != it.value().end(); ++screenIt) {
+            screenIt.value().remove(client);
+        }
+    }
+    m_mostRecentlyUsed.remove(client);
+    auto it = m_screenConnections.find(client);
+    if (it != m_screenConnections.end()) {
+        disconnect(it.value());
+        m_screenConnections.erase(it);
     }
-    m_mostRecentlyUsed.removeAll(client);
 }
 
 void FocusChain::resize(uint previousSize, uint newSize)
 {
     for (uint i = previousSize + 1; i <= newSize; ++i) {
-        m_desktopFocusChains.insert(i, QList<AbstractClient*>());
+        m_desktopFocusChains.insert(i, Chain());
+        m_screenFocusChains.insert(i, QHash<int, Chain>());
     }
     for (uint i = previousSize; i > newSize; --i) {
         m_desktopFocusChains.remove(i);
+        m_screenFocusChains.remove(i);
     }
 }
 
@@ -66,16 +215,27 @@ AbstractClient *FocusChain::getForActivation(uint desktop) const
 
 AbstractClient *FocusChain::getForActivation(uint desktop, int screen) const
 {
-    DesktopChains::const_iterator it = m_desktopFocusChains.find(desktop);
-    if (it == m_desktopFocusChains.constEnd()) {
-        return NULL;
+    const Chain *chain = nullptr;
+    if (m_separateScreenFocus) {
+        ScreenChains::const_iterator it = m_screenFocusChains.find(desktop);
+        if (it == m_screenFocusChains.constEnd()) {
+            return NULL;
+        }
+        auto screenIt = it.value().constFind(screen);
+        if (screenIt == it.value().constEnd()) {
+            return NULL;
+        }
+        chain = &screenIt.value();
+    } else {
+        DesktopChains::const_iterator it = m_desktopFocusChains.find(desktop);
+        if (it == m_desktopFocusChains.constEnd()) {
+            return NULL;
+        }
+        chain = &it.value();
     }
-    const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto tmp = chain.at(i);
+    for (auto tmp = chain->last(); tmp; tmp = chain->previous(tmp)) {
         // TODO: move the check into Client
-        if (tmp->isShown(false) && tmp->isOnCurrentActivity()
-            && ( !m_separateScreenFocus || tmp->screen() == screen)) {
+        if (tmp->isShown(false) && tmp->isOnCurrentActivity()) {
             return tmp;
         }
     }
@@ -89,6 +249,7 @@ void FocusChain::update(AbstractClient *client, FocusChain::Change change)
         remove(client);
         return;
     }
+    track(client);
 
     if (client->isOnAllDesktops()) {
         // Now on all desktops, add it to focus chains it is not already in
@@ -107,6 +268,7 @@ void FocusChain::update(AbstractClient *client, FocusChain::Change change)
             } else {
                 insertClientIntoChain(client, chain);
             }
+            updateScreenChains(client, it.key());
         }
     } else {
         // Now only on desktop, remove it anywhere else
@@ -117,8 +279,9 @@ void FocusChain::update(AbstractClient *client, FocusChain::Change change)
             if (client->isOnDesktop(it.key())) {
                 updateClientInChain(client, change, chain);
             } else {
-                chain.removeAll(client);
+                chain.remove(client);
             }
+            updateScreenChains(client, it.key());
         }
     }
 
@@ -126,7 +289,66 @@ void FocusChain::update(AbstractClient *client, FocusChain::Change change)
     updateClientInChain(client, change, m_mostRecentlyUsed);
 }
 
-void FocusChain::updateClientInChain(AbstractClient *client, FocusChain::Change change, QList< AbstractClient * >& chain)
+void FocusChain::track(AbstractClient *client)
+{
+    if (m_screenConnections.contains(client)) {
+        return;
+    }
+    m_screenConnections.insert(client, connect(client, &AbstractClient::screenChanged, this,
+        [this, client] {
+            updateScreen(client);
+        }
+    ));
+}
+
+void FocusChain::updateScreen(AbstractClient *client)
+{
+    for (DesktopChains::const_iterator it = m_desktopFocusChains.constBegin();
+            it != m_desktopFocusChains.constEnd();
+            ++it) {
+        if (it.value().contains(client)) {
+            updateScreenChains(client, it.key());
+        }
+    }
+}
+
+void FocusChain::updateScreenChains(AbstractClient *client, uint desktop)
+{
+    auto &screenChains = m_screenFocusChains[desktop];
+    for (auto it = screenChains.begin(); it != screenChains.end(); ++it) {
+        it.value().remove(client);
+    }
+    const Chain &chain = m_desktopFocusChains[desktop];
+    if (!chain.contains(client)) {
+        return;
+    }
+    Chain &screenChain = screenChains[client->screen()];
+    // place it next to the closest neighbor on the same screen, searching in both directions
+    AbstractClient *before = chain.previous(client);
+    AbstractClient *after = chain.next(client);
+    while (true) {
+        if (!after) {
+            screenChain.append(client);
+            return;
+        }
+        if (screenChain.contains(after)) {
+            screenChain.insertBefore(client, after);
+            return;
+        }
+        if (!before) {
+            screenChain.prepend(client);
+            return;
+        }
+        if (screenChain.contains(before)) {
+            screenChain.insertAfter(client, before);
+            return;
+        }
+        after = chain.next(after);
+        before = chain.previous(before);
+    }
+}
+
+void FocusChain::updateClientInChain(AbstractClient *client, FocusChain::Change change, Chain &chain)
 {
     if (change == MakeFirst) {
         makeFirstInChain(client, chain);
@@ -137,15 +359,15 @@ void FocusChain::updateClientInChain(AbstractClient *client, FocusChain::Change
     }
 }
 
-void FocusChain::insertClientIntoChain(AbstractClient *client, QList< AbstractClient * >& chain)
+void FocusChain::insertClientIntoChain(AbstractClient *client, Chain &chain)
 {
     if (chain.contains(client)) {
         return;
     }
     if (m_activeClient && m_activeClient != client &&
-            !chain.empty() && chain.last() == m_activeClient) {
+            !chain.isEmpty() && chain.last() == m_activeClient) {
         // Add it after the active client
-        chain.insert(chain.size() - 1, client);
+        chain.insertBefore(client, m_activeClient);
     } else {
         // Otherwise add as the first one
         chain.append(client);
@@ -165,23 +387,23 @@ void FocusChain::moveAfterClient(AbstractClient *client, AbstractClient *referen
             continue;
         }
         moveAfterClientInChain(client, reference, it.value());
+        updateScreenChains(client, it.key());
     }
     moveAfterClientInChain(client, reference, m_mostRecentlyUsed);
 }
 
-void FocusChain::moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, QList<AbstractClient *> &chain)
+void FocusChain::moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, Chain &chain)
 {
     if (!chain.contains(reference)) {
         return;
     }
     if (AbstractClient::belongToSameApplication(reference, client)) {
-        chain.removeAll(client);
-        chain.insert(chain.indexOf(reference), client);
+        chain.insertBefore(client, reference);
     } else {
-        chain.removeAll(client);
-        for (int i = chain.size() - 1; i >= 0; --i) {
-            if (AbstractClient::belongToSameApplication(reference, chain.at(i))) {
-                chain.insert(i, client);
+        chain.remove(client);
+        for (auto c = chain.last(); c; c = chain.previous(c)) {
+            if (AbstractClient::belongToSameApplication(reference, c)) {
+                chain.insertBefore(client, c);
                 break;
             }
         }
@@ -201,14 +423,13 @@ AbstractClient *FocusChain::nextMostRecentlyUsed(AbstractClient *reference) cons
     if (m_mostRecentlyUsed.isEmpty()) {
         return NULL;
     }
-    const int index = m_mostRecentlyUsed.indexOf(reference);
-    if (index == -1) {
+    if (!m_mostRecentlyUsed.contains(reference)) {
         return m_mostRecentlyUsed.first();
     }
-    if (index == 0) {
+    if (reference == m_mostRecentlyUsed.first()) {
         return m_mostRecentlyUsed.last();
     }
-    return m_mostRecentlyUsed.at(index - 1);
+    return m_mostRecentlyUsed.previous(reference);
 }
 
 // copied from activation.cpp
@@ -226,8 +447,7 @@ AbstractClient *FocusChain::nextForDesktop(AbstractClient *reference, uint deskt
         return NULL;
     }
     const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto client = chain.at(i);
+    for (auto client = chain.last(); client; client = chain.previous(client)) {
         if (isUsableFocusCandidate(client, reference)) {
             return client;
         }
@@ -235,13 +455,13 @@ AbstractClient *FocusChain::nextForDesktop(AbstractClient *reference, uint deskt
     return NULL;
 }
 
-void FocusChain::makeFirstInChain(AbstractClient *client, QList< AbstractClient * >& chain)
+void FocusChain::makeFirstInChain(AbstractClient *client, Chain &chain)
 {
-    chain.removeAll(client);
+    chain.remove(client);
     if (client->isMinimized()) { // add it before the first minimized ...
-        for (int i = chain.count()-1; i >= 0; --i) {
-            if (chain.at(i)->isMinimized()) {
-                chain.insert(i+1, client);
+        for (auto c = chain.last(); c; c = chain.previous(c)) {
+            if (c->isMinimized()) {
+                chain.insertAfter(client, c);
                 return;
             }
         }
@@ -251,9 +471,8 @@ void FocusChain::makeFirstInChain(AbstractClient *client, QList< AbstractClient
     }
 }
 
-void FocusChain::makeLastInChain(AbstractClient *client, QList< AbstractClient * >& chain)
+void FocusChain::makeLastInChain(AbstractClient *client, Chain &chain)
 {
-    chain.removeAll(client);
     chain.prepend(client);
 }
 
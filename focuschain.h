@@ -37,11 +37,14 @@ class AbstractClient;
  *
  * Internally this FocusChain holds multiple independent chains. There is one chain of most recently
  * used Clients which is primarily used by TabBox to build up the list of Clients for navigation.
- * The chains are organized as a normal QList of Clients with the most recently used Client being the
- * last item of the list, that is a LIFO like structure.
+ * The chains are organized as doubly linked lists of Clients with the most recently used Client being
+ * the last item of the list, that is a LIFO like structure. Looking up, removing and moving a Client
+ * to either end of a chain are constant time operations.
  *
  * In addition there is one chain for each virtual desktop which is used to determine which Client
- * should get activated when the user switches to another virtual desktop.
+ * should get activated when the user switches to another virtual desktop. Each per virtual desktop
+ * chain is further split into one chain per screen, which keeps the order of the desktop's chain
+ * and is used to find the Client for activation when separate screen focus is used.
  *
  * Furthermore this class contains various helper methods for the two different kind of chains.
  **/
@@ -189,6 +192,42 @@ public Q_SLOTS:
     bool isUsableFocusCandidate(AbstractClient *c, AbstractClient *prev) const;
 
 private:
+    /**
+     * @brief Doubly linked list of Clients used as a focus chain.
+     *
+     * The first item is the least recently used Client, the last item the most recently used one.
+     **/
+    class Chain
+    {
+    public:
+        bool contains(AbstractClient *client) const;
+        bool isEmpty() const;
+        int size() const;
+        AbstractClient *first() const;
+        AbstractClient *last() const;
+        /**
+         * @returns The Client before @p client, that is the next less recently used one, or @c null.
+         **/
+        AbstractClient *previous(AbstractClient *client) const;
+        /**
+         * @returns The Client after @p client, that is the next more recently used one, or @c null.
+         **/
+        AbstractClient *next(AbstractClient *client) const;
+        void append(AbstractClient *client);
+        void prepend(AbstractClient *client);
+        void insertBefore(AbstractClient *client, AbstractClient *reference);
+        void insertAfter(AbstractClient *client, AbstractClient *reference);
+        void remove(AbstractClient *client);
+
+    private:
+        struct Link {
+            AbstractClient *previous = nullptr;
+            AbstractClient *next = nullptr;
+        };
+        QHash<AbstractClient*, Link> m_links;
+        AbstractClient *m_first = nullptr;
+        AbstractClient *m_last = nullptr;
+    };
     /**
      * @brief Makes @p client the first Client in the given focus @p chain.
      *
@@ -199,7 +238,7 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeFirstInChain(AbstractClient *client, QList<AbstractClient*> &chain);
+    void makeFirstInChain(AbstractClient *client, Chain &chain);
     /**
      * @brief Makes @p client the last Client in the given focus @p chain.
      *
@@ -210,13 +249,27 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeLastInChain(AbstractClient *client, QList<AbstractClient*> &chain);
-    void moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, QList<AbstractClient*> &chain);
-    void updateClientInChain(AbstractClient *client, Change change, QList<AbstractClient*> &chain);
-    void insertClientIntoChain(AbstractClient *client, QList<AbstractClient*> &chain);
-    typedef QHash<uint, QList<AbstractClient*> > DesktopChains;
-    QList<AbstractClient*> m_mostRecentlyUsed;
+    void makeLastInChain(AbstractClient *client, Chain &chain);
+    void moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, Chain &chain);
+    void updateClientInChain(AbstractClient *client, Change change, Chain &chain);
+    void insertClientIntoChain(AbstractClient *client, Chain &chain);
+    /**
+     * @brief Updates the position of @p client in the per screen chains of @p desktop to match its
+     * position in the focus chain of @p desktop.
+     *
+     * The Client is placed next to its closest neighbor on the same screen in the desktop's chain.
+     * The neighbors are searched in both directions at once, so that the common cases of the Client
+     * being the most recently used or next to the active Client are constant time.
+     **/
+    void updateScreenChains(AbstractClient *client, uint desktop);
+    void updateScreen(AbstractClient *client);
+    void track(AbstractClient *client);
+    typedef QHash<uint, Chain> DesktopChains;
+    typedef QHash<uint, QHash<int, Chain> > ScreenChains;
+    Chain m_mostRecentlyUsed;
     DesktopChains m_desktopFocusChains;
+    ScreenChains m_screenFocusChains;
+    QHash<AbstractClient*, QMetaObject::Connection> m_screenConnections;
     bool m_separateScreenFocus;
     AbstractClient *m_activeClient;
     uint m_currentDesktop;
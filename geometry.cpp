@@ -39,6 +39,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "screens.h"
 #include "effects.h"
 #include "screenedge.h"
+#include "snapedgeindex.h"
 #include <QApplication>
 #include <QDebug>
 #include <QVarLengthArray>
@@ -454,8 +455,10 @@ QPoint Workspace::adjustClientPosition(Client* c, QPoint pos, bool unrestricted,
         // windows snap
         int snap = options->windowSnapZone() * snapAdjust;
         if (snap) {
+            // only windows with an edge inside the snap zone can influence the position
+            const ClientList candidates = m_snapEdgeIndex->candidates(c->desktop(), QRect(cx, cy, cw, ch), snap);
             QList<Client *>::ConstIterator l;
-            for (l = clients.constBegin(); l != clients.constEnd(); ++l) {
+            for (l = candidates.constBegin(); l != candidates.constEnd(); ++l) {
                 if ((*l) == c)
                     continue;
                 if ((*l)->isMinimized())
@@ -651,8 +654,13 @@ QRect Workspace::adjustClientSize(Client* c, QRect moveResizeGeom, int mode)
         if (snap) {
             deltaX = int(snap);
             deltaY = int(snap);
+            // the edges being resized can jump by up to one snap zone when snapping to a
+            // window, so look for candidates in twice the zone around them
+            const ClientList candidates = m_snapEdgeIndex->candidates(VirtualDesktopManager::self()->current(),
+                                                                      QRect(QPoint(newcx, newcy), QPoint(newrx, newry)),
+                                                                      2 * snap + 2);
             QList<Client *>::ConstIterator l;
-            for (l = clients.constBegin(); l != clients.constEnd(); ++l) {
+            for (l = candidates.constBegin(); l != candidates.constEnd(); ++l) {
                 if ((*l)->isOnDesktop(VirtualDesktopManager::self()->current()) &&
                         !(*l)->isMinimized()
                         && (*l) != c) {
@@ -2653,6 +2661,7 @@ void Client::leaveMoveResize()
     moveResizeMode = false;
     if (syncRequest.counter == XCB_NONE) // don't forget to sanitize since the timeout will no more fire
         syncRequest.isPending = false;
+    syncRequest.hasPendingMotion = false;
     delete syncRequest.timeout;
     syncRequest.timeout = NULL;
     if (ScreenEdges::self()->isDesktopSwitchingMovingClients())
@@ -2735,8 +2744,15 @@ void Client::stopDelayedMoveResize()
 
 void Client::handleMoveResize(int x, int y, int x_root, int y_root)
 {
-    if (syncRequest.isPending && isResize())
-        return; // we're still waiting for the client or the timeout
+    if (syncRequest.isPending && isResize()) {
+        // we're still waiting for the client or the timeout, intermediate steps are dropped
+        // but the most recent one is applied once the client caught up
+        syncRequest.hasPendingMotion = true;
+        syncRequest.pendingMotion = QPoint(x, y);
+        syncRequest.pendingMotionRoot = QPoint(x_root, y_root);
+        return;
+    }
+    syncRequest.hasPendingMotion = false;
 
     if ((mode == PositionCenter && !isMovableAcrossScreens())
             || (mode != PositionCenter && (isShade() || !isResizable())))
@@ -3014,14 +3030,23 @@ void Client::handleMoveResize(int x, int y, int x_root, int y_root)
             sendSyncRequest();
         } else {                            // for clients not supporting the XSYNC protocol, we
             syncRequest.isPending = true;   // limit the resizes to 30Hz to take pointless load from X11
-            syncRequest.timeout->start(33); // and the client, the mouse is still moved at full speed
-        }                                   // and no human can control faster resizes anyway
+                                            // and the client, the mouse is still moved at full speed
+                                            // and no human can control faster resizes anyway
+            int interval = 33;
+            if (Compositor::compositing()) {
+                // use the nearest whole number of frames, e.g. two frames at 60 Hz
+                const qint64 frameInterval = qMax<qint64>(Compositor::self()->frameInterval(), 1);
+                const qint64 frames = qMax<qint64>((interval * 1000000ll + frameInterval / 2) / frameInterval, 1);
+                interval = qMax<qint64>(frames * frameInterval / 1000000, 1);
+            }
+            syncRequest.timeout->start(interval);
+        }
         m_client.setGeometry(0, 0, moveResizeGeom.width() - (borderLeft() + borderRight()), moveResizeGeom.height() - (borderTop() + borderBottom()));
     } else
         performMoveResize();
 
     if (isMove()) {
-        ScreenEdges::self()->check(globalPos, QDateTime::fromMSecsSinceEpoch(xTime()));
+        ScreenEdges::self()->check(globalPos);
     }
 }
 
@@ -3037,6 +3062,20 @@ void Client::performMoveResize()
         addRepaintFull();
     positionGeometryTip();
     emit clientStepUserMovedResized(this, moveResizeGeom);
+    if (syncRequest.hasPendingMotion && !syncRequest.isPending) {
+        // don't start the next step from within the current one
+        QMetaObject::invokeMethod(this, "performPendingMoveResize", Qt::QueuedConnection);
+    }
+}
+
+void Client::performPendingMoveResize()
+{
+    if (!syncRequest.hasPendingMotion || syncRequest.isPending || !moveResizeMode) {
+        return;
+    }
+    syncRequest.hasPendingMotion = false;
+    handleMoveResize(syncRequest.pendingMotion.x(), syncRequest.pendingMotion.y(),
+                     syncRequest.pendingMotionRoot.x(), syncRequest.pendingMotionRoot.y());
 }
 
 void Client::setElectricBorderMode(QuickTileMode mode)
@@ -0,0 +1,176 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "hittestindex.h"
+#include "client.h"
+#include "screens.h"
+#include "workspace.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace KWin
+{
+
+static const int s_cellSize = 256;
+
+HitTestIndex::HitTestIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+HitTestIndex::~HitTestIndex() = default;
+
+bool HitTestIndex::acceptsInput(Toplevel *t)
+{
+    if (t->isDeleted()) {
+        // a deleted window doesn't get mouse events
+        return false;
+    }
+    if (t->isClient()) {
+        Client *c = static_cast<Client*>(t);
+        if (!c->isOnCurrentActivity() || !c->isOnCurrentDesktop() || c->isMinimized() || !c->isCurrentTab()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Toplevel *HitTestIndex::at(const QPoint &pos)
+{
+    const ToplevelList &stacking = Workspace::self()->stackingOrder();
+    const QRect bounds = screens()->geometry();
+    if (!stacking.isSharedWith(m_stacking) || bounds != m_bounds) {
+        rebuild(stacking, bounds);
+    }
+    if (m_lastHit && m_lastHitArea.contains(pos) && acceptsInput(m_lastHit)) {
+        return m_lastHit;
+    }
+    m_lastHit = nullptr;
+    if (!m_bounds.contains(pos)) {
+        // not covered by the grid
+        for (int i = m_entries.count() - 1; i >= 0; --i) {
+            const Entry &entry = m_entries.at(i);
+            if (entry.geometry.contains(pos) && acceptsInput(entry.window)) {
+                return entry.window;
+            }
+        }
+        return nullptr;
+    }
+    const int column = (pos.x() - m_bounds.x()) / s_cellSize;
+    const int row = (pos.y() - m_bounds.y()) / s_cellSize;
+    const QVector<int> &cell = m_cells.at(row * m_columns + column);
+    for (int i = 0; i < cell.count(); ++i) {
+        const Entry &entry = m_entries.at(cell.at(i));
+        if (!entry.geometry.contains(pos) || !acceptsInput(entry.window)) {
+            continue;
+        }
+        if (i == 0) {
+            // nothing above it in this cell
+            m_lastHit = entry.window;
+            m_lastHitArea = entry.geometry & cellGeometry(column, row);
+        }
+        return entry.window;
+    }
+    return nullptr;
+}
+
+void HitTestIndex::rebuild(const ToplevelList &stacking, const QRect &bounds)
+{
+    m_stacking = stacking;
+    m_bounds = bounds;
+    m_columns = (bounds.width() + s_cellSize - 1) / s_cellSize;
+    m_rows = (bounds.height() + s_cellSize - 1) / s_cellSize;
+    m_lastHit = nullptr;
+    m_entries.clear();
+    m_entries.reserve(stacking.count());
+    m_indexes.clear();
+    m_cells.clear();
+    m_cells.resize(m_columns * m_rows);
+    for (auto it = stacking.constBegin(); it != stacking.constEnd(); ++it) {
+        Toplevel *t = *it;
+        m_indexes.insert(t, m_entries.count());
+        m_entries << Entry{t, t->geometry()};
+        connect(t, &Toplevel::geometryChanged, this, &HitTestIndex::updateGeometry, Qt::UniqueConnection);
+    }
+    // adding bottom to top allows to prepend
+    for (int i = 0; i < m_entries.count(); ++i) {
+        const QRect range = cellRange(m_entries.at(i).geometry);
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            for (int column = range.left(); column <= range.right(); ++column) {
+                m_cells[row * m_columns + column].prepend(i);
+            }
+        }
+    }
+}
+
+void HitTestIndex::updateGeometry()
+{
+    Toplevel *t = static_cast<Toplevel*>(sender());
+    auto it = m_indexes.constFind(t);
+    if (it == m_indexes.constEnd()) {
+        return;
+    }
+    const int index = it.value();
+    if (m_entries.at(index).window != t) {
+        return;
+    }
+    removeFromCells(index);
+    m_entries[index].geometry = t->geometry();
+    addToCells(index);
+    m_lastHit = nullptr;
+}
+
+void HitTestIndex::addToCells(int index)
+{
+    const QRect range = cellRange(m_entries.at(index).geometry);
+    for (int row = range.top(); row <= range.bottom(); ++row) {
+        for (int column = range.left(); column <= range.right(); ++column) {
+            QVector<int> &cell = m_cells[row * m_columns + column];
+            cell.insert(std::lower_bound(cell.begin(), cell.end(), index, std::greater<int>()), index);
+        }
+    }
+}
+
+void HitTestIndex::removeFromCells(int index)
+{
+    const QRect range = cellRange(m_entries.at(index).geometry);
+    for (int row = range.top(); row <= range.bottom(); ++row) {
+        for (int column = range.left(); column <= range.right(); ++column) {
+            m_cells[row * m_columns + column].removeOne(index);
+        }
+    }
+}
+
+QRect HitTestIndex::cellRange(const QRect &geometry) const
+{
+    const QRect clipped = geometry & m_bounds;
+    if (clipped.isEmpty()) {
+        return QRect();
+    }
+    return QRect(QPoint((clipped.left() - m_bounds.x()) / s_cellSize, (clipped.top() - m_bounds.y()) / s_cellSize),
+                 QPoint((clipped.right() - m_bounds.x()) / s_cellSize, (clipped.bottom() - m_bounds.y()) / s_cellSize));
+}
+
+QRect HitTestIndex::cellGeometry(int column, int row) const
+{
+    return QRect(m_bounds.x() + column * s_cellSize, m_bounds.y() + row * s_cellSize, s_cellSize, s_cellSize);
+}
+
+} // namespace
@@ -0,0 +1,96 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_HIT_TEST_INDEX_H
+#define KWIN_HIT_TEST_INDEX_H
+// KWin
+#include "utils.h"
+// Qt
+#include <QHash>
+#include <QObject>
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief Spatial index of the stacking order used to find the window at a position.
+ *
+ * InputRedirection::findToplevel is called for each pointer and touch motion event. Instead of
+ * walking the whole stacking order the HitTestIndex splits the screen area into a grid of cells.
+ * Each cell knows the windows intersecting it, sorted top most first, so a lookup only tests the
+ * few windows of one cell.
+ *
+ * The index is rebuilt lazily on the next lookup once Workspace's stacking order or the screen
+ * area changed. Geometry changes of indexed windows only move the window between cells.
+ *
+ * Whether a window accepts input (virtual desktop, activity, minimized, tab) is evaluated at
+ * lookup time, so that changes to it do not need to invalidate the index.
+ *
+ * If the last hit window was the top most window of its cell the part of its geometry within the
+ * cell is remembered. As long as the position stays inside that area the window is returned
+ * without looking at the cell.
+ **/
+class HitTestIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HitTestIndex(QObject *parent = nullptr);
+    virtual ~HitTestIndex();
+
+    /**
+     * @returns The top most window of Workspace's stacking order accepting input at @p pos,
+     * @c null if there is none.
+     **/
+    Toplevel *at(const QPoint &pos);
+
+private Q_SLOTS:
+    void updateGeometry();
+
+private:
+    struct Entry {
+        Toplevel *window;
+        QRect geometry;
+    };
+    static bool acceptsInput(Toplevel *t);
+    void rebuild(const ToplevelList &stacking, const QRect &bounds);
+    void addToCells(int index);
+    void removeFromCells(int index);
+    QRect cellRange(const QRect &geometry) const;
+    QRect cellGeometry(int column, int row) const;
+
+    // a copy of the stacking order the index got built from, shares the data with Workspace's
+    // list until that one gets changed
+    ToplevelList m_stacking;
+    QRect m_bounds;
+    int m_columns = 0;
+    int m_rows = 0;
+    // in stacking order, bottom most first
+    QVector<Entry> m_entries;
+    QHash<Toplevel*, int> m_indexes;
+    // for each cell the indexes of the intersecting entries, top most first
+    QVector<QVector<int> > m_cells;
+    Toplevel *m_lastHit = nullptr;
+    QRect m_lastHitArea;
+};
+
+} // namespace
+
+#endif // KWIN_HIT_TEST_INDEX_H
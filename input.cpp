@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "client.h"
 #include "effects.h"
 #include "globalshortcuts.h"
+#include "hittestindex.h"
 #include "logind.h"
 #include "main.h"
 #ifdef KWIN_BUILD_TABBOX
@@ -41,6 +42,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QThread>
 // KDE
 #include <kkeyserver.h>
 #if HAVE_XKB
@@ -199,6 +201,7 @@ InputRedirection::InputRedirection(QObject *parent)
 #endif
     , m_pointerWindow()
     , m_shortcuts(new GlobalShortcutsManager(this))
+    , m_hitTestIndex(new HitTestIndex(this))
 {
 #if HAVE_INPUT
     if (Application::usesLibinput()) {
@@ -213,6 +216,13 @@ InputRedirection::InputRedirection(QObject *parent)
 
 InputRedirection::~InputRedirection()
 {
+#if HAVE_INPUT
+    if (m_libInput) {
+        m_libInput->deleteLater();
+        m_libInputThread->quit();
+        m_libInputThread->wait();
+    }
+#endif
     s_self = NULL;
 }
 
@@ -236,9 +246,17 @@ void InputRedirection::setupLibInput()
     if (m_libInput) {
         return;
     }
-    LibInput::Connection *conn = LibInput::Connection::create(this);
+    LibInput::Connection *conn = LibInput::Connection::create();
     m_libInput = conn;
     if (conn) {
+        m_libInputThread = new QThread(this);
+        conn->moveToThread(m_libInputThread);
+        m_libInputThread->start();
+        connect(conn, &LibInput::Connection::eventsRead, this,
+            [this] {
+                m_libInput->processEvents();
+            }, Qt::QueuedConnection
+        );
         conn->setup();
         connect(conn, &LibInput::Connection::pointerButtonChanged, this, &InputRedirection::processPointerButton);
         connect(conn, &LibInput::Connection::pointerAxisChanged, this, &InputRedirection::processPointerAxis);
@@ -294,7 +312,7 @@ void InputRedirection::setupLibInput()
                 }
             );
         }
-        connect(VirtualTerminal::self(), &VirtualTerminal::activeChanged, m_libInput,
+        connect(VirtualTerminal::self(), &VirtualTerminal::activeChanged, this,
             [this] (bool active) {
                 if (!active) {
                     m_libInput->deactivate();
@@ -757,29 +775,10 @@ Toplevel *InputRedirection::findToplevel(const QPoint &pos)
             return u;
         }
     }
-    const ToplevelList &stacking = Workspace::self()->stackingOrder();
-    if (stacking.isEmpty()) {
-        return NULL;
+    if (!screens()) {
+        return nullptr;
     }
-    auto it = stacking.end();
-    do {
-        --it;
-        Toplevel *t = (*it);
-        if (t->isDeleted()) {
-            // a deleted window doesn't get mouse events
-            continue;
-        }
-        if (t->isClient()) {
-            Client *c = static_cast<Client*>(t);
-            if (!c->isOnCurrentActivity() || !c->isOnCurrentDesktop() || c->isMinimized() || !c->isCurrentTab()) {
-                continue;
-            }
-        }
-        if (t->geometry().contains(pos)) {
-            return t;
-        }
-    } while (it != stacking.begin());
-    return NULL;
+    return m_hitTestIndex->at(pos);
 }
 
 uint8_t InputRedirection::toXPointerButton(uint32_t button)
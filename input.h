@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <config-kwin.h>
 
 class QKeySequence;
+class QThread;
 
 struct xkb_context;
 struct xkb_keymap;
@@ -39,6 +40,7 @@ typedef uint32_t xkb_keysym_t;
 namespace KWin
 {
 class GlobalShortcutsManager;
+class HitTestIndex;
 class Toplevel;
 class Xkb;
 
@@ -202,8 +204,10 @@ private:
     QHash<qint32, qint32> m_touchIdMapper;
 
     GlobalShortcutsManager *m_shortcuts;
+    HitTestIndex *m_hitTestIndex;
 
     LibInput::Connection *m_libInput = nullptr;
+    QThread *m_libInputThread = nullptr;
 
     KWIN_SINGLETON(InputRedirection)
     friend InputRedirection *input();
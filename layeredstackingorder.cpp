@@ -0,0 +1,220 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "layeredstackingorder.h"
+
+#include <QHash>
+#include <QPair>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+bool LayeredStackingOrder::Window::operator==(const Window &other) const
+{
+    return toplevel == other.toplevel
+        && layer == other.layer
+        && screen == other.screen
+        && group == other.group
+        && hasTransients == other.hasTransients
+        && mainWindows == other.mainWindows;
+}
+
+LayeredStackingOrder::LayeredStackingOrder() = default;
+
+LayeredStackingOrder::~LayeredStackingOrder() = default;
+
+const ToplevelList &LayeredStackingOrder::update(const QVector<Window> &unconstrained)
+{
+    if (!moveWindow(unconstrained)) {
+        rebuild(unconstrained);
+    }
+    return m_order;
+}
+
+void LayeredStackingOrder::rebuild(const QVector<Window> &unconstrained)
+{
+    m_unconstrained = unconstrained;
+
+    // build the order from layers
+    QVector<Entry> layer[NumLayers];
+    QHash<QPair<int, Group*>, Layer> minimumLayer;
+    QHash<Toplevel*, const Window*> windows;
+    windows.reserve(unconstrained.count());
+    for (auto it = unconstrained.constBegin(); it != unconstrained.constEnd(); ++it) {
+        windows.insert(it->toplevel, it);
+        Layer l = it->layer;
+        if (it->group) {
+            const QPair<int, Group*> key(it->screen, it->group);
+            auto mLayer = minimumLayer.find(key);
+            if (mLayer != minimumLayer.end()) {
+                // If a window is raised above some other window in the same window group
+                // which is in the ActiveLayer (i.e. it's fulscreened), make sure it stays
+                // above that window (see #95731).
+                if (*mLayer == ActiveLayer && (l > BelowLayer))
+                    l = ActiveLayer;
+                *mLayer = l;
+            } else {
+                minimumLayer.insert(key, l);
+            }
+        }
+        Entry entry;
+        entry.toplevel = it->toplevel;
+        entry.layer = l;
+        layer[ l ].append(entry);
+    }
+    m_entries.clear();
+    m_entries.reserve(unconstrained.count());
+    for (Layer lay = FirstLayer;
+            lay < NumLayers;
+            ++lay)
+        m_entries += layer[ lay ];
+
+    // now keep transients above their mainwindows
+    for (int i = m_entries.size() - 1;
+            i >= 0;
+       ) {
+        const Window *current = windows.value(m_entries.at(i).toplevel);
+        if (current->mainWindows.isEmpty()) {
+            --i;
+            continue;
+        }
+        // find the topmost mainwindow
+        int i2 = m_entries.size() - 1;
+        for (;
+                i2 >= 0;
+                --i2) {
+            if (i2 == i) {
+                i2 = -1; // don't reorder, already on top of its mainwindows
+                break;
+            }
+            if (current->mainWindows.contains(m_entries.at(i2).toplevel))
+                break;
+        }
+        if (i2 == -1) {
+            --i;
+            continue;
+        }
+        Entry entry = m_entries.at(i);
+        entry.transient = true;
+        m_entries.remove(i);
+        --i; // move onto the next item (for next for () iteration)
+        --i2; // adjust index of the mainwindow after the remove above
+        if (current->hasTransients)   // this one now can be possibly above its transients,
+            i = i2; // so go again higher in the stack order and possibly move those transients again
+        ++i2; // insert after (on top of) the mainwindow, it's ok if it2 is now m_entries.end()
+        m_entries.insert(i2, entry);
+    }
+    updateOrder();
+}
+
+bool LayeredStackingOrder::moveWindow(const QVector<Window> &unconstrained)
+{
+    const QVector<Window> &old = m_unconstrained;
+    const int count = unconstrained.count();
+    if (old.count() != count) {
+        return false;
+    }
+    // the range [first, last] of the unconstrained order changed
+    int first = 0;
+    while (first < count && old.at(first) == unconstrained.at(first)) {
+        ++first;
+    }
+    if (first == count) {
+        return true;
+    }
+    int last = count - 1;
+    while (old.at(last) == unconstrained.at(last)) {
+        --last;
+    }
+    // a single window moved from one end of the range to the other one
+    const Window *window = nullptr;
+    if (unconstrained.at(last) == old.at(first)
+            && std::equal(old.constBegin() + first + 1, old.constBegin() + last + 1, unconstrained.constBegin() + first)) {
+        window = &unconstrained.at(last);
+    } else if (unconstrained.at(first) == old.at(last)
+            && std::equal(old.constBegin() + first, old.constBegin() + last, unconstrained.constBegin() + first + 1)) {
+        window = &unconstrained.at(first);
+    }
+    if (!window) {
+        return false;
+    }
+    // neither the transient rules nor the ActiveLayer of the group may depend on the position
+    // of the window, then it does not influence where any other window ends up
+    if (!window->mainWindows.isEmpty() || window->hasTransients) {
+        return false;
+    }
+    if (window->group) {
+        for (auto it = unconstrained.constBegin(); it != unconstrained.constEnd(); ++it) {
+            if (it->group == window->group && it->layer == ActiveLayer) {
+                return false;
+            }
+        }
+    }
+    m_unconstrained = unconstrained;
+    restack(*window);
+    updateOrder();
+    return true;
+}
+
+void LayeredStackingOrder::restack(const Window &window)
+{
+    QHash<Toplevel*, int> positions;
+    positions.reserve(m_unconstrained.count());
+    for (int i = 0; i < m_unconstrained.count(); ++i) {
+        positions.insert(m_unconstrained.at(i).toplevel, i);
+    }
+    for (int i = 0; i < m_entries.count(); ++i) {
+        if (m_entries.at(i).toplevel == window.toplevel) {
+            m_entries.remove(i);
+            break;
+        }
+    }
+    // the windows which did not get moved on top of a mainwindow are still sorted by layer and
+    // their position in the unconstrained order, the transients follow their mainwindows
+    const int position = positions.value(window.toplevel);
+    int index = m_entries.count();
+    for (int i = 0; i < m_entries.count(); ++i) {
+        const Entry &other = m_entries.at(i);
+        if (other.transient) {
+            continue;
+        }
+        if (other.layer > window.layer
+                || (other.layer == window.layer && positions.value(other.toplevel) > position)) {
+            index = i;
+            break;
+        }
+    }
+    Entry entry;
+    entry.toplevel = window.toplevel;
+    entry.layer = window.layer;
+    m_entries.insert(index, entry);
+}
+
+void LayeredStackingOrder::updateOrder()
+{
+    m_order.clear();
+    m_order.reserve(m_entries.count());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        m_order << it->toplevel;
+    }
+}
+
+} // namespace
@@ -0,0 +1,97 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_LAYERED_STACKING_ORDER_H
+#define KWIN_LAYERED_STACKING_ORDER_H
+// KWin
+#include "utils.h"
+// Qt
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief Builds the constrained stacking order from Workspace's unconstrained stacking order.
+ *
+ * The windows are sorted into their layers, a window in the same group above an active
+ * fullscreen window is kept in the ActiveLayer, and transients are moved on top of their
+ * main windows, see layers.cpp. The transient relations are passed in as a tree: every
+ * transient lists the windows it has to be kept above.
+ *
+ * The result of the last build is kept together with the windows it got built from. If the
+ * only change of the next unconstrained stacking order is a single window being raised, lowered
+ * or restacked, and that window neither is kept above a main window nor has transients nor is
+ * in a group with a window in the ActiveLayer, the window is just moved within its layer in the
+ * constrained stacking order. All other changes rebuild the order.
+ **/
+class LayeredStackingOrder
+{
+public:
+    /**
+     * A window of the unconstrained stacking order with everything its position in the
+     * constrained stacking order depends on.
+     **/
+    struct Window {
+        Toplevel *toplevel = nullptr;
+        Layer layer = UnknownLayer;
+        int screen = 0;
+        // nullptr for windows which are not Clients
+        Group *group = nullptr;
+        bool hasTransients = false;
+        // the windows this transient has to be kept above, it is moved on top of the top most
+        // of them which is below it
+        QVector<Toplevel*> mainWindows;
+
+        bool operator==(const Window &other) const;
+        bool operator!=(const Window &other) const {
+            return !(*this == other);
+        }
+    };
+
+    LayeredStackingOrder();
+    ~LayeredStackingOrder();
+
+    /**
+     * @returns The constrained stacking order for the @p unconstrained stacking order, bottom
+     * most window first.
+     **/
+    const ToplevelList &update(const QVector<Window> &unconstrained);
+
+private:
+    struct Entry {
+        Toplevel *toplevel = nullptr;
+        // the layer the window got sorted into
+        Layer layer = UnknownLayer;
+        // whether the window got moved on top of one of its main windows
+        bool transient = false;
+    };
+    void rebuild(const QVector<Window> &unconstrained);
+    bool moveWindow(const QVector<Window> &unconstrained);
+    void restack(const Window &window);
+    void updateOrder();
+
+    QVector<Window> m_unconstrained;
+    QVector<Entry> m_entries;
+    ToplevelList m_order;
+};
+
+} // namespace
+
+#endif // KWIN_LAYERED_STACKING_ORDER_H
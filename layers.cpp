@@ -92,6 +92,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "effects.h"
 #include "composite.h"
 #include "screenedge.h"
+#include "stackingindex.h"
+#include "layeredstackingorder.h"
 
 #include <QDebug>
 
@@ -117,6 +119,10 @@ void Workspace::updateStackingOrder(bool propagate_new_clients)
     }
     ToplevelList new_stacking_order = constrainedStackingOrder();
     bool changed = (force_restacking || new_stacking_order != stacking_order);
+    if (force_restacking) {
+        // don't trust the window stack we propagated last time
+        m_propagatedWindowStack.clear();
+    }
     force_restacking = false;
     stacking_order = new_stacking_order;
 #if 0
@@ -152,6 +158,37 @@ void Workspace::stackScreenEdgesUnderOverrideRedirect()
     Xcb::restackWindows(QVector<xcb_window_t>() << rootInfo()->supportWindow() << ScreenEdges::self()->windows());
 }
 
+/*!
+  Restacks the windows in \a newStack, assuming that the X server has them in the
+  order of \a oldStack. The first \a fixed windows (support window and screen edges)
+  are always restacked, as they can be raised behind our back. Of the remaining windows
+  only the range between the common head and the common tail of both stacks is sent
+  to the X server, so that raising a single window doesn't restack all windows.
+ */
+static void restackWindowsDelta(const QVector<xcb_window_t> &oldStack, const QVector<xcb_window_t> &newStack, int fixed)
+{
+    Xcb::restackWindows(newStack.mid(0, fixed));
+    int head = fixed;
+    const int maxCommon = qMin(oldStack.size(), newStack.size());
+    if (oldStack.mid(0, fixed) == newStack.mid(0, fixed)) {
+        while (head < maxCommon && oldStack.at(head) == newStack.at(head)) {
+            ++head;
+        }
+    }
+    if (head == newStack.size() && head == oldStack.size()) {
+        // nothing changed
+        return;
+    }
+    int tail = 0;
+    while (tail < maxCommon - head &&
+            oldStack.at(oldStack.size() - 1 - tail) == newStack.at(newStack.size() - 1 - tail)) {
+        ++tail;
+    }
+    // windows in the changed range are stacked below the last window of the common head
+    const int first = qMax(head - 1, fixed - 1);
+    Xcb::restackWindows(newStack.mid(first, newStack.size() - tail - first));
+}
+
 /*!
   Propagates the managed clients to the world.
   Called ONLY from updateStackingOrder().
@@ -170,6 +207,7 @@ void Workspace::propagateClients(bool propagate_new_clients)
     newWindowStack << rootInfo()->supportWindow();
 
     newWindowStack << ScreenEdges::self()->windows();
+    const int clientsStart = newWindowStack.size();
 
     newWindowStack.reserve(newWindowStack.size() + 2*stacking_order.size()); // *2 for inputWindow
 
@@ -195,10 +233,10 @@ void Workspace::propagateClients(bool propagate_new_clients)
             continue;
         newWindowStack << client->frameId();
     }
-    // TODO isn't it too inefficient to restack always all clients?
     // TODO don't restack not visible windows?
     assert(newWindowStack.at(0) == rootInfo()->supportWindow());
-    Xcb::restackWindows(newWindowStack);
+    restackWindowsDelta(m_propagatedWindowStack, newWindowStack, clientsStart);
+    m_propagatedWindowStack = newWindowStack;
 
     int pos = 0;
     xcb_window_t *cl(nullptr);
@@ -238,7 +276,7 @@ Client* Workspace::topClientOnDesktop(int desktop, int screen, bool unconstraine
 // TODO    Q_ASSERT( block_stacking_updates == 0 );
     ToplevelList list;
     if (!unconstrained)
-        list = stacking_order;
+        list = stackingOrderOnDesktop(desktop);
     else
         list = unconstrained_stacking_order;
     for (int i = list.size() - 1;
@@ -263,15 +301,16 @@ Client* Workspace::topClientOnDesktop(int desktop, int screen, bool unconstraine
 Client* Workspace::findDesktop(bool topmost, int desktop) const
 {
 // TODO    Q_ASSERT( block_stacking_updates == 0 );
+    const ToplevelList &list = stackingOrderOnDesktop(desktop);
     if (topmost) {
-        for (int i = stacking_order.size() - 1; i >= 0; i--) {
-            Client *c = qobject_cast<Client*>(stacking_order.at(i));
+        for (int i = list.size() - 1; i >= 0; i--) {
+            Client *c = qobject_cast<Client*>(list.at(i));
             if (c && c->isOnDesktop(desktop) && c->isDesktop()
                     && c->isShown(true))
                 return c;
         }
     } else { // bottom-most
-        foreach (Toplevel * c, stacking_order) {
+        foreach (Toplevel * c, list) {
             Client *client = qobject_cast<Client*>(c);
             if (client && c->isOnDesktop(desktop) && c->isDesktop()
                     && client->isShown(true))
@@ -486,119 +525,45 @@ void Workspace::restoreSessionStackingOrder(Client* c)
 
 /*!
   Returns a stacking order based upon \a list that fulfills certain contained.
+  The layers and the transient rules are applied by the LayeredStackingOrder. If just
+  a single window without transient relations got raised or lowered since the last
+  call, it only moves that window within its layer.
  */
 ToplevelList Workspace::constrainedStackingOrder()
 {
-    ToplevelList layer[ NumLayers ];
-
-#if 0
-    qCDebug(KWIN_CORE) << "stacking1:";
-    for (ClientList::ConstIterator it = unconstrained_stacking_order.begin();
-            it != unconstrained_stacking_order.end();
-            ++it)
-        qCDebug(KWIN_CORE) << (void*)(*it) << *it << ":" << (*it)->layer();
-#endif
-    // build the order from layers
-    QVector< QMap<Group*, Layer> > minimum_layer(screens()->count());
+    QVector<LayeredStackingOrder::Window> windows;
+    windows.reserve(unconstrained_stacking_order.count());
     for (ToplevelList::ConstIterator it = unconstrained_stacking_order.constBegin(),
                                   end = unconstrained_stacking_order.constEnd(); it != end; ++it) {
-        Layer l = (*it)->layer();
-
-        const int screen = (*it)->screen();
+        LayeredStackingOrder::Window window;
+        window.toplevel = *it;
+        window.layer = (*it)->layer();
+        window.screen = (*it)->screen();
         Client *c = qobject_cast<Client*>(*it);
-        QMap< Group*, Layer >::iterator mLayer = minimum_layer[screen].find(c ? c->group() : NULL);
-        if (mLayer != minimum_layer[screen].end()) {
-            // If a window is raised above some other window in the same window group
-            // which is in the ActiveLayer (i.e. it's fulscreened), make sure it stays
-            // above that window (see #95731).
-            if (*mLayer == ActiveLayer && (l > BelowLayer))
-                l = ActiveLayer;
-            *mLayer = l;
-        } else if (c) {
-            minimum_layer[screen].insertMulti(c->group(), l);
-        }
-        layer[ l ].append(*it);
-    }
-    ToplevelList stacking;
-    for (Layer lay = FirstLayer;
-            lay < NumLayers;
-            ++lay)
-        stacking += layer[ lay ];
-#if 0
-    qCDebug(KWIN_CORE) << "stacking2:";
-    for (ClientList::ConstIterator it = stacking.begin();
-            it != stacking.end();
-            ++it)
-        qCDebug(KWIN_CORE) << (void*)(*it) << *it << ":" << (*it)->layer();
-#endif
-    // now keep transients above their mainwindows
-    // TODO this could(?) use some optimization
-    for (int i = stacking.size() - 1;
-            i >= 0;
-       ) {
-        Client *current = qobject_cast<Client*>(stacking[i]);
-        if (!current || !current->isTransient()) {
-            --i;
+        if (!c) {
+            windows << window;
             continue;
         }
-        int i2 = -1;
-        if (current->groupTransient()) {
-            if (current->group()->members().count() > 0) {
-                // find topmost client this one is transient for
-                for (i2 = stacking.size() - 1;
-                        i2 >= 0;
-                        --i2) {
-                    if (stacking[ i2 ] == stacking[ i ]) {
-                        i2 = -1; // don't reorder, already the topmost in the group
-                        break;
+        window.group = c->group();
+        window.hasTransients = !c->transients().isEmpty();
+        // the transient tree, the windows each transient has to be kept above
+        if (c->isTransient()) {
+            if (c->groupTransient()) {
+                if (c->group()->members().count() > 0) {
+                    foreach (Toplevel *t, unconstrained_stacking_order) {
+                        Client *c2 = qobject_cast<Client*>(t);
+                        if (c2 && c2 != c && c2->hasTransient(c, true) && keepTransientAbove(c2, c))
+                            window.mainWindows << c2;
                     }
-                    Client *c2 = qobject_cast<Client*>(stacking[ i2 ]);
-                    if (!c2) {
-                        continue;
-                    }
-                    if (c2->hasTransient(current, true)
-                            && keepTransientAbove(c2, current))
-                        break;
-                }
-            } // else i2 remains pointing at -1
-        } else {
-            for (i2 = stacking.size() - 1;
-                    i2 >= 0;
-                    --i2) {
-                Client *c2 = qobject_cast<Client*>(stacking[ i2 ]);
-                if (!c2) {
-                    continue;
                 }
-                if (c2 == current) {
-                    i2 = -1; // don't reorder, already on top of its mainwindow
-                    break;
-                }
-                if (c2 == current->transientFor()
-                        && keepTransientAbove(c2, current))
-                    break;
+            } else if (Client *mainwindow = c->transientFor()) {
+                if (keepTransientAbove(mainwindow, c))
+                    window.mainWindows << mainwindow;
             }
         }
-        if (i2 == -1) {
-            --i;
-            continue;
-        }
-        stacking.removeAt(i);
-        --i; // move onto the next item (for next for () iteration)
-        --i2; // adjust index of the mainwindow after the remove above
-        if (!current->transients().isEmpty())   // this one now can be possibly above its transients,
-            i = i2; // so go again higher in the stack order and possibly move those transients again
-        ++i2; // insert after (on top of) the mainwindow, it's ok if it2 is now stacking.end()
-        stacking.insert(i2, current);
+        windows << window;
     }
-#if 0
-    qCDebug(KWIN_CORE) << "stacking3:";
-    for (ClientList::ConstIterator it = stacking.begin();
-            it != stacking.end();
-            ++it)
-        qCDebug(KWIN_CORE) << (void*)(*it) << *it << ":" << (*it)->layer();
-    qCDebug(KWIN_CORE) << "\n\n";
-#endif
-    return stacking;
+    return m_layeredStackingOrder->update(windows);
 }
 
 void Workspace::blockStackingUpdates(bool block)
@@ -656,6 +621,16 @@ bool Workspace::keepTransientAbove(const Client* mainwindow, const Client* trans
     return true;
 }
 
+const ToplevelList& Workspace::stackingOrderOnDesktop(uint desktop) const
+{
+    return m_stackingIndex->onDesktop(stacking_order, desktop);
+}
+
+const ToplevelList& Workspace::stackingOrderOnActivity(const QString &activity) const
+{
+    return m_stackingIndex->onActivity(stacking_order, activity);
+}
+
 // Returns all windows in their stacking order on the root window.
 ToplevelList Workspace::xStackingOrder() const
 {
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../udev.h"
 
 #include <QDebug>
+#include <QMutexLocker>
 #include <QSocketNotifier>
 
 #include <libinput.h>
@@ -87,6 +88,11 @@ Connection::~Connection()
 }
 
 void Connection::setup()
+{
+    QMetaObject::invokeMethod(this, "doSetup", Qt::QueuedConnection);
+}
+
+void Connection::doSetup()
 {
     Q_ASSERT(!m_notifier);
     m_notifier = new QSocketNotifier(m_input->fileDescriptor(), QSocketNotifier::Read, this);
@@ -101,17 +107,11 @@ void Connection::setup()
                 }
                 m_input->resume();
                 handleEvent();
-                if (m_keyboardBeforeSuspend && !m_keyboard) {
-                    emit hasKeyboardChanged(false);
-                }
-                if (m_pointerBeforeSuspend && !m_pointer) {
-                    emit hasPointerChanged(false);
-                }
-                if (m_touchBeforeSuspend && !m_touch) {
-                    emit hasTouchChanged(false);
-                }
+                QueuedEvent resumed;
+                resumed.type = QueuedEvent::Type::Resumed;
+                enqueue(resumed);
             } else {
-                deactivate();
+                doDeactivate();
             }
         }
     );
@@ -119,135 +119,261 @@ void Connection::setup()
 }
 
 void Connection::deactivate()
+{
+    QMetaObject::invokeMethod(this, "doDeactivate", Qt::QueuedConnection);
+}
+
+void Connection::doDeactivate()
 {
     if (m_input->isSuspended()) {
         return;
     }
-    m_keyboardBeforeSuspend = hasKeyboard();
-    m_pointerBeforeSuspend = hasPointer();
-    m_touchBeforeSuspend = hasTouch();
+    // queued before the removal of the devices, so that the main thread still knows them
+    QueuedEvent suspended;
+    suspended.type = QueuedEvent::Type::Suspended;
+    enqueue(suspended);
     m_input->suspend();
     handleEvent();
 }
 
+void Connection::enqueue(const QueuedEvent &event)
+{
+    QMutexLocker locker(&m_mutex);
+    const bool wasEmpty = m_eventQueue.isEmpty();
+    if (!wasEmpty && event.type == m_eventQueue.last().type) {
+        QueuedEvent &last = m_eventQueue.last();
+        if (event.type == QueuedEvent::Type::PointerMotion) {
+            last.delta += event.delta;
+            last.time = event.time;
+            return;
+        }
+        if (event.type == QueuedEvent::Type::PointerMotionAbsolute) {
+            last = event;
+            return;
+        }
+    }
+    m_eventQueue << event;
+    if (wasEmpty) {
+        emit eventsRead();
+    }
+}
+
 void Connection::handleEvent()
 {
+    QSize size;
+    {
+        QMutexLocker locker(&m_mutex);
+        size = m_size;
+    }
     do {
         m_input->dispatch();
         QScopedPointer<Event> event(m_input->event());
         if (event.isNull()) {
             break;
         }
+        QueuedEvent queued;
         switch (event->type()) {
             case LIBINPUT_EVENT_DEVICE_ADDED:
-                if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_KEYBOARD)) {
-                    m_keyboard++;
-                    if (m_keyboard == 1) {
-                        emit hasKeyboardChanged(true);
-                    }
-                }
-                if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_POINTER)) {
-                    m_pointer++;
-                    if (m_pointer == 1) {
-                        emit hasPointerChanged(true);
-                    }
-                }
-                if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_TOUCH)) {
-                    m_touch++;
-                    if (m_touch == 1) {
-                        emit hasTouchChanged(true);
-                    }
-                }
-                break;
             case LIBINPUT_EVENT_DEVICE_REMOVED:
-                if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_KEYBOARD)) {
-                    m_keyboard--;
-                    if (m_keyboard == 0) {
-                        emit hasKeyboardChanged(false);
-                    }
-                }
-                if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_POINTER)) {
-                    m_pointer--;
-                    if (m_pointer == 0) {
-                        emit hasPointerChanged(false);
-                    }
-                }
-                if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_TOUCH)) {
-                    m_touch--;
-                    if (m_touch == 0) {
-                        emit hasTouchChanged(false);
-                    }
-                }
+                queued.type = event->type() == LIBINPUT_EVENT_DEVICE_ADDED ? QueuedEvent::Type::DeviceAdded : QueuedEvent::Type::DeviceRemoved;
+                queued.keyboard = libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_KEYBOARD);
+                queued.pointer = libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_POINTER);
+                queued.touch = libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_TOUCH);
                 break;
             case LIBINPUT_EVENT_KEYBOARD_KEY: {
                 KeyEvent *ke = static_cast<KeyEvent*>(event.data());
-                emit keyChanged(ke->key(), ke->state(), ke->time());
+                queued.type = QueuedEvent::Type::Key;
+                queued.code = ke->key();
+                queued.keyState = ke->state();
+                queued.time = ke->time();
                 break;
             }
             case LIBINPUT_EVENT_POINTER_AXIS: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
                 const auto axis = pe->axis();
+                queued.type = QueuedEvent::Type::PointerAxis;
+                queued.time = pe->time();
                 for (auto it = axis.begin(); it != axis.end(); ++it) {
-                    emit pointerAxisChanged(*it, pe->axisValue(*it), pe->time());
+                    queued.axis = *it;
+                    queued.axisDelta = pe->axisValue(*it);
+                    enqueue(queued);
                 }
-                break;
+                continue;
             }
             case LIBINPUT_EVENT_POINTER_BUTTON: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
-                emit pointerButtonChanged(pe->button(), pe->buttonState(), pe->time());
+                queued.type = QueuedEvent::Type::PointerButton;
+                queued.code = pe->button();
+                queued.buttonState = pe->buttonState();
+                queued.time = pe->time();
                 break;
             }
             case LIBINPUT_EVENT_POINTER_MOTION: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
-                emit pointerMotion(pe->delta(), pe->time());
+                queued.type = QueuedEvent::Type::PointerMotion;
+                queued.delta = pe->delta();
+                queued.time = pe->time();
                 break;
             }
             case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
-                emit pointerMotionAbsolute(pe->absolutePos(), pe->absolutePos(m_size), pe->time());
+                queued.type = QueuedEvent::Type::PointerMotionAbsolute;
+                queued.delta = pe->absolutePos();
+                queued.pos = pe->absolutePos(size);
+                queued.time = pe->time();
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_DOWN: {
                 TouchEvent *te = static_cast<TouchEvent*>(event.data());
-                emit touchDown(te->id(), te->absolutePos(m_size), te->time());
+                queued.type = QueuedEvent::Type::TouchDown;
+                queued.code = te->id();
+                queued.pos = te->absolutePos(size);
+                queued.time = te->time();
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_UP: {
                 TouchEvent *te = static_cast<TouchEvent*>(event.data());
-                emit touchUp(te->id(), te->time());
+                queued.type = QueuedEvent::Type::TouchUp;
+                queued.code = te->id();
+                queued.time = te->time();
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_MOTION: {
                 TouchEvent *te = static_cast<TouchEvent*>(event.data());
-                emit touchMotion(te->id(), te->absolutePos(m_size), te->time());
+                queued.type = QueuedEvent::Type::TouchMotion;
+                queued.code = te->id();
+                queued.pos = te->absolutePos(size);
+                queued.time = te->time();
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_CANCEL: {
-                emit touchCanceled();
+                queued.type = QueuedEvent::Type::TouchCancel;
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_FRAME: {
-                emit touchFrame();
+                queued.type = QueuedEvent::Type::TouchFrame;
                 break;
             }
             default:
                 // nothing
-                break;
+                continue;
         }
+        enqueue(queued);
     } while (true);
 }
 
+void Connection::processEvents()
+{
+    QVector<QueuedEvent> events;
+    {
+        QMutexLocker locker(&m_mutex);
+        events.swap(m_eventQueue);
+    }
+    for (auto it = events.constBegin(); it != events.constEnd(); ++it) {
+        const QueuedEvent &event = *it;
+        switch (event.type) {
+            case QueuedEvent::Type::DeviceAdded:
+                if (event.keyboard) {
+                    m_keyboard++;
+                    if (m_keyboard == 1) {
+                        emit hasKeyboardChanged(true);
+                    }
+                }
+                if (event.pointer) {
+                    m_pointer++;
+                    if (m_pointer == 1) {
+                        emit hasPointerChanged(true);
+                    }
+                }
+                if (event.touch) {
+                    m_touch++;
+                    if (m_touch == 1) {
+                        emit hasTouchChanged(true);
+                    }
+                }
+                break;
+            case QueuedEvent::Type::DeviceRemoved:
+                if (event.keyboard) {
+                    m_keyboard--;
+                    if (m_keyboard == 0) {
+                        emit hasKeyboardChanged(false);
+                    }
+                }
+                if (event.pointer) {
+                    m_pointer--;
+                    if (m_pointer == 0) {
+                        emit hasPointerChanged(false);
+                    }
+                }
+                if (event.touch) {
+                    m_touch--;
+                    if (m_touch == 0) {
+                        emit hasTouchChanged(false);
+                    }
+                }
+                break;
+            case QueuedEvent::Type::Key:
+                emit keyChanged(event.code, event.keyState, event.time);
+                break;
+            case QueuedEvent::Type::PointerAxis:
+                emit pointerAxisChanged(event.axis, event.axisDelta, event.time);
+                break;
+            case QueuedEvent::Type::PointerButton:
+                emit pointerButtonChanged(event.code, event.buttonState, event.time);
+                break;
+            case QueuedEvent::Type::PointerMotion:
+                emit pointerMotion(event.delta, event.time);
+                break;
+            case QueuedEvent::Type::PointerMotionAbsolute:
+                emit pointerMotionAbsolute(event.delta, event.pos, event.time);
+                break;
+            case QueuedEvent::Type::TouchDown:
+                emit touchDown(event.code, event.pos, event.time);
+                break;
+            case QueuedEvent::Type::TouchUp:
+                emit touchUp(event.code, event.time);
+                break;
+            case QueuedEvent::Type::TouchMotion:
+                emit touchMotion(event.code, event.pos, event.time);
+                break;
+            case QueuedEvent::Type::TouchCancel:
+                emit touchCanceled();
+                break;
+            case QueuedEvent::Type::TouchFrame:
+                emit touchFrame();
+                break;
+            case QueuedEvent::Type::Suspended:
+                m_suspended = true;
+                m_keyboardBeforeSuspend = hasKeyboard();
+                m_pointerBeforeSuspend = hasPointer();
+                m_touchBeforeSuspend = hasTouch();
+                break;
+            case QueuedEvent::Type::Resumed:
+                // changes while suspended got ignored, announce the difference to before
+                m_suspended = false;
+                if (m_keyboardBeforeSuspend != hasKeyboard()) {
+                    emit hasKeyboardChanged(hasKeyboard());
+                }
+                if (m_pointerBeforeSuspend != hasPointer()) {
+                    emit hasPointerChanged(hasPointer());
+                }
+                if (m_touchBeforeSuspend != hasTouch()) {
+                    emit hasTouchChanged(hasTouch());
+                }
+                break;
+        }
+    }
+}
+
 void Connection::setScreenSize(const QSize &size)
 {
+    QMutexLocker locker(&m_mutex);
     m_size = size;
 }
 
 bool Connection::isSuspended() const
 {
-    if (!s_context) {
-        return false;
-    }
-    return s_context->isSuspended();
+    return m_suspended;
 }
 
 }
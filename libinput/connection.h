@@ -23,8 +23,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../input.h"
 #include <kwinglobals.h>
 
+#include <QMutex>
 #include <QObject>
+#include <QPointF>
 #include <QSize>
+#include <QVector>
 
 class QSocketNotifier;
 
@@ -35,18 +38,37 @@ namespace LibInput
 
 class Context;
 
+/**
+ * @brief The connection to libinput.
+ *
+ * The Connection lives in a dedicated input thread, in which libinput gets dispatched and its
+ * events get decoded. The decoded events are queued and the eventsRead signal notifies the main
+ * thread, which delivers them by calling processEvents. Thus input gets read even while the main
+ * thread is busy, and the signals of the Connection are emitted from the main thread.
+ *
+ * Relative pointer motion not yet picked up by the main thread gets accumulated into one motion,
+ * absolute pointer motion only keeps the latest position.
+ **/
 class Connection : public QObject
 {
     Q_OBJECT
 public:
     ~Connection();
 
+    /**
+     * Starts reading events in the thread the Connection got moved to.
+     **/
     void setup();
     /**
      * Sets the screen @p size. This is needed for mapping absolute pointer events to
      * the screen data.
      **/
     void setScreenSize(const QSize &size);
+    /**
+     * Delivers all queued events by emitting the corresponding signals.
+     * To be called from the main thread in response to eventsRead.
+     **/
+    void processEvents();
 
     bool hasKeyboard() const {
         return m_keyboard > 0;
@@ -63,6 +85,10 @@ public:
     void deactivate();
 
 Q_SIGNALS:
+    /**
+     * Emitted from the input thread when events got queued while the queue was empty.
+     **/
+    void eventsRead();
     void keyChanged(uint32_t key, InputRedirection::KeyboardKeyState, uint32_t time);
     void pointerButtonChanged(uint32_t button, InputRedirection::PointerButtonState state, uint32_t time);
     void pointerMotionAbsolute(QPointF orig, QPointF screen, uint32_t time);
@@ -77,15 +103,60 @@ Q_SIGNALS:
     void hasPointerChanged(bool);
     void hasTouchChanged(bool);
 
+private Q_SLOTS:
+    void doSetup();
+    void doDeactivate();
+
 private:
+    /**
+     * An event decoded in the input thread, waiting to be delivered in the main thread.
+     **/
+    struct QueuedEvent {
+        enum class Type {
+            DeviceAdded,
+            DeviceRemoved,
+            Key,
+            PointerButton,
+            PointerAxis,
+            PointerMotion,
+            PointerMotionAbsolute,
+            TouchDown,
+            TouchUp,
+            TouchMotion,
+            TouchCancel,
+            TouchFrame,
+            Suspended,
+            Resumed
+        };
+        Type type = Type::TouchFrame;
+        quint32 time = 0;
+        // key, button or touch id
+        qint32 code = 0;
+        InputRedirection::KeyboardKeyState keyState = InputRedirection::KeyboardKeyReleased;
+        InputRedirection::PointerButtonState buttonState = InputRedirection::PointerButtonReleased;
+        InputRedirection::PointerAxis axis = InputRedirection::PointerAxisVertical;
+        qreal axisDelta = 0.0;
+        // delta for relative motion, untransformed position for absolute motion
+        QPointF delta;
+        QPointF pos;
+        bool keyboard = false;
+        bool pointer = false;
+        bool touch = false;
+    };
     Connection(Context *input, QObject *parent = nullptr);
     void handleEvent();
+    void enqueue(const QueuedEvent &event);
     Context *m_input;
     QSocketNotifier *m_notifier;
+    // guards m_size and m_eventQueue, shared between the input and the main thread
+    QMutex m_mutex;
     QSize m_size;
+    QVector<QueuedEvent> m_eventQueue;
+    // only used from the main thread
     int m_keyboard = 0;
     int m_pointer = 0;
     int m_touch = 0;
+    bool m_suspended = false;
     bool m_keyboardBeforeSuspend = false;
     bool m_pointerBeforeSuspend = false;
     bool m_touchBeforeSuspend = false;
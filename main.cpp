@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "options.h"
 #include "screens.h"
 #include "sm.h"
+#include "startuptrace.h"
 #include "workspace.h"
 #include "xcbutils.h"
 
@@ -194,6 +195,7 @@ void Application::start()
 
     crashChecking();
 
+    StartupTrace::begin(QStringLiteral("Startup until Workspace"));
     performStartup();
 }
 
@@ -372,7 +374,11 @@ void Application::createWorkspace()
     // critical startup section where x errors cause kwin to abort.
 
     // create workspace.
-    (void) new Workspace(isSessionRestored());
+    {
+        StartupTrace::Scope trace(QStringLiteral("Workspace"));
+        (void) new Workspace(isSessionRestored());
+    }
+    StartupTrace::end(QStringLiteral("Startup until Workspace"));
     emit workspaceCreated();
 }
 
@@ -399,6 +405,7 @@ void Application::createAtoms()
 
 void Application::createOptions()
 {
+    StartupTrace::Scope trace(QStringLiteral("Options"));
     options = new Options;
 }
 
@@ -54,6 +54,18 @@ bool Client::manage(xcb_window_t w, bool isMapped)
 
     Xcb::WindowAttributes attr(w);
     Xcb::WindowGeometry windowGeometry(w);
+    const bool managed = manage(w, isMapped, attr, windowGeometry);
+
+    ungrabXServer();
+    return managed;
+}
+
+bool Client::manage(xcb_window_t w, bool isMapped, Xcb::WindowAttributes &attr, Xcb::WindowGeometry &windowGeometry)
+{
+    StackingUpdatesBlocker stacking_blocker(workspace());
+
+    grabXServer();
+
     if (attr.isNull() || windowGeometry.isNull()) {
         ungrabXServer();
         return false;
@@ -106,6 +118,8 @@ bool Client::manage(xcb_window_t w, bool isMapped)
     auto firstInTabBoxCookie = fetchFirstInTabBox();
     auto transientCookie = fetchTransient();
     auto activitiesCookie = fetchActivities();
+    auto syncCounterCookie = fetchSyncCounter();
+    auto shapeCookie = fetchShape(window());
     m_geometryHints.init(window());
     m_motif.init(window());
     info = new WinInfo(this, m_client, rootWindow(), properties, properties2);
@@ -118,7 +132,7 @@ bool Client::manage(xcb_window_t w, bool isMapped)
     getResourceClass();
     readWmClientLeader(wmClientLeaderCookie);
     getWmClientMachine();
-    getSyncCounter();
+    readSyncCounter(syncCounterCookie);
     // First only read the caption text, so that setupWindowRules() can use it for matching,
     // and only then really set the caption using setCaption(), which checks for duplicates etc.
     // and also relies on rules already existing
@@ -128,7 +142,8 @@ bool Client::manage(xcb_window_t w, bool isMapped)
 
     if (Xcb::Extensions::self()->isShapeAvailable())
         xcb_shape_select_input(connection(), window(), true);
-    detectShape(window());
+    // the server is grabbed, so the shape cannot change before we selected for its events
+    readShape(shapeCookie);
     readGtkFrameExtents(gtkFrameExtentsCookie);
     detectNoBorder();
     fetchIconicName();
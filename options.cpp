@@ -97,6 +97,7 @@ Options::Options(QObject *parent)
     , m_maxFpsInterval(Options::defaultMaxFpsInterval())
     , m_refreshRate(Options::defaultRefreshRate())
     , m_vBlankTime(Options::defaultVBlankTime())
+    , m_thumbnailMaxFps(Options::defaultThumbnailMaxFps())
     , m_glStrictBinding(Options::defaultGlStrictBinding())
     , m_glStrictBindingFollowsDriver(Options::defaultGlStrictBindingFollowsDriver())
     , m_glCoreProfile(Options::defaultGLCoreProfile())
@@ -678,6 +679,15 @@ void Options::setVBlankTime(qint64 vBlankTime)
     emit vBlankTimeChanged();
 }
 
+void Options::setThumbnailMaxFps(uint thumbnailMaxFps)
+{
+    if (m_thumbnailMaxFps == thumbnailMaxFps) {
+        return;
+    }
+    m_thumbnailMaxFps = thumbnailMaxFps;
+    emit thumbnailMaxFpsChanged();
+}
+
 void Options::setGlStrictBinding(bool glStrictBinding)
 {
     if (m_glStrictBinding == glStrictBinding) {
@@ -820,6 +830,7 @@ void Options::loadConfig()
     setMaxFpsInterval(1 * 1000 * 1000 * 1000 / config.readEntry("MaxFPS", Options::defaultMaxFps()));
     setRefreshRate(config.readEntry("RefreshRate", Options::defaultRefreshRate()));
     setVBlankTime(config.readEntry("VBlankTime", Options::defaultVBlankTime()) * 1000); // config in micro, value in nano resolution
+    setThumbnailMaxFps(config.readEntry("ThumbnailMaxFPS", Options::defaultThumbnailMaxFps()));
 }
 
 void Options::syncFromKcfgc()
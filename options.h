@@ -181,6 +181,11 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(qint64 maxFpsInterval READ maxFpsInterval WRITE setMaxFpsInterval NOTIFY maxFpsIntervalChanged)
     Q_PROPERTY(uint refreshRate READ refreshRate WRITE setRefreshRate NOTIFY refreshRateChanged)
     Q_PROPERTY(qint64 vBlankTime READ vBlankTime WRITE setVBlankTime NOTIFY vBlankTimeChanged)
+    /**
+     * The maximum number of times per second a window or desktop thumbnail gets updated for
+     * damage of the thumbnailed windows, 0 for no limit.
+     **/
+    Q_PROPERTY(uint thumbnailMaxFps READ thumbnailMaxFps WRITE setThumbnailMaxFps NOTIFY thumbnailMaxFpsChanged)
     Q_PROPERTY(bool glStrictBinding READ isGlStrictBinding WRITE setGlStrictBinding NOTIFY glStrictBindingChanged)
     /**
      * Whether strict binding follows the driver or has been overwritten by a user defined config value.
@@ -571,6 +576,9 @@ public:
     qint64 vBlankTime() const {
         return m_vBlankTime;
     }
+    uint thumbnailMaxFps() const {
+        return m_thumbnailMaxFps;
+    }
     bool isGlStrictBinding() const {
         return m_glStrictBinding;
     }
@@ -646,6 +654,7 @@ public:
     void setMaxFpsInterval(qint64 maxFpsInterval);
     void setRefreshRate(uint refreshRate);
     void setVBlankTime(qint64 vBlankTime);
+    void setThumbnailMaxFps(uint thumbnailMaxFps);
     void setGlStrictBinding(bool glStrictBinding);
     void setGlStrictBindingFollowsDriver(bool glStrictBindingFollowsDriver);
     void setGLCoreProfile(bool glCoreProfile);
@@ -752,6 +761,9 @@ public:
     static uint defaultVBlankTime() {
         return 6000; // 6ms
     }
+    static uint defaultThumbnailMaxFps() {
+        return 15;
+    }
     static bool defaultGlStrictBinding() {
         return true;
     }
@@ -842,6 +854,7 @@ Q_SIGNALS:
     void maxFpsIntervalChanged();
     void refreshRateChanged();
     void vBlankTimeChanged();
+    void thumbnailMaxFpsChanged();
     void glStrictBindingChanged();
     void glStrictBindingFollowsDriverChanged();
     void glCoreProfileChanged();
@@ -892,6 +905,7 @@ private:
     // Settings that should be auto-detected
     uint m_refreshRate;
     qint64 m_vBlankTime;
+    uint m_thumbnailMaxFps;
     bool m_glStrictBinding;
     bool m_glStrictBindingFollowsDriver;
     bool m_glCoreProfile;
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "client.h"
 #include "client_machine.h"
 #include "screens.h"
+#include "startuptrace.h"
 #include "workspace.h"
 #endif
 
@@ -1000,7 +1001,13 @@ void RuleBook::edit(AbstractClient* c, bool whole_app)
 
 void RuleBook::load()
 {
-    deleteAll();
+    setRules(readRules());
+}
+
+QList<Rules*> RuleBook::readRules()
+{
+    StartupTrace::Scope trace(QStringLiteral("Reading window rules"));
+    QList<Rules*> rules;
     KConfig cfg(QStringLiteral(KWIN_NAME) + QStringLiteral("rulesrc"), KConfig::NoGlobals);
     int count = cfg.group("General").readEntry("count", 0);
     for (int i = 1;
@@ -1008,8 +1015,15 @@ void RuleBook::load()
             ++i) {
         KConfigGroup cg(&cfg, QString::number(i));
         Rules* rule = new Rules(cg);
-        m_rules.append(rule);
+        rules.append(rule);
     }
+    return rules;
+}
+
+void RuleBook::setRules(const QList<Rules*> &rules)
+{
+    deleteAll();
+    m_rules = rules;
 }
 
 void RuleBook::save()
@@ -293,6 +293,15 @@ public:
     void setUpdatesDisabled(bool disable);
     bool areUpdatesDisabled() const;
     void load();
+    /**
+     * Reads the rules from the config file without touching the RuleBook, can be called from
+     * any thread. The returned rules are passed to setRules.
+     **/
+    static QList<Rules*> readRules();
+    /**
+     * Replaces the current rules by @p rules, taking ownership of them.
+     **/
+    void setRules(const QList<Rules*> &rules);
     void edit(AbstractClient* c, bool whole_app);
     void requestDiskStorage();
 private Q_SLOTS:
@@ -71,10 +71,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QQuickWindow>
 #include <QVector2D>
 
+#include "composite.h"
 #include "client.h"
 #include "deleted.h"
 #include "effects.h"
 #include "overlaywindow.h"
+#include "scene_scanout.h"
 #include "screens.h"
 #include "shadow.h"
 
@@ -185,6 +187,71 @@ void Scene::updateTimeDiff()
         time_diff = 1;
 }
 
+QRegion Scene::pendingRepaints(const QRegion &damage) const
+{
+    QRegion region = damage;
+    foreach (Window *w, stacking_order) {
+        region |= w->window()->repaints();
+    }
+    return region;
+}
+
+void Scene::deferRepaint(const QRegion &region)
+{
+    if (region.isEmpty()) {
+        return;
+    }
+    // the window repaints are reset by painting the other screens, so keep them as screen damage.
+    // Not passed to the Compositor as that would trigger a new frame on every composite timer tick
+    m_deferredRepaints |= region;
+}
+
+QRegion Scene::takeDeferredRepaints(const QRect &geometry)
+{
+    const QRegion region = m_deferredRepaints & geometry;
+    m_deferredRepaints -= region;
+    return region;
+}
+
+Toplevel *Scene::scanoutCandidate(const QRect &geometry) const
+{
+#if HAVE_WAYLAND
+    // a fullscreen effect replaces the windows on the screen
+    if (effects->activeFullScreenEffect()) {
+        return nullptr;
+    }
+    for (auto it = stacking_order.constEnd(); it != stacking_order.constBegin();) {
+        --it;
+        Window *w = *it;
+        Toplevel *t = w->window();
+        if (!w->isVisible() || !t->visibleRect().intersects(geometry)) {
+            continue;
+        }
+        // the top most window on the screen has to hide everything below it
+        if (t->visibleRect() != geometry || !w->isOpaque() || !t->surface()) {
+            return nullptr;
+        }
+        // other effects are active all the time, only the ones changing this window matter
+        static_cast<EffectsHandlerImpl*>(effects)->startPaint();
+        w->resetPaintingEnabled();
+        if (!effectsKeepWindowUnchanged(effectWindow(w), geometry)) {
+            return nullptr;
+        }
+        return t;
+    }
+#else
+    Q_UNUSED(geometry)
+#endif
+    return nullptr;
+}
+
+void Scene::resetWindowRepaints()
+{
+    foreach (Window *w, stacking_order) {
+        w->window()->resetRepaints();
+    }
+}
+
 // Painting pass is optimized away.
 void Scene::idle()
 {
@@ -480,7 +547,7 @@ void Scene::paintWindow(Window* w, int mask, QRegion region, WindowQuadList quad
     // paint thumbnails on top of window
     paintWindowThumbnails(w, region, data.opacity(), data.brightness(), data.saturation());
     // and desktop thumbnails
-    paintDesktopThumbnails(w);
+    paintDesktopThumbnails(w, region);
 }
 
 static void adjustClipRegion(AbstractThumbnailItem *item, QRegion &clippingRegion)
@@ -556,11 +623,14 @@ void Scene::paintWindowThumbnails(Scene::Window *w, QRegion region, qreal opacit
         QRegion clippingRegion = region;
         clippingRegion &= QRegion(wImpl->x(), wImpl->y(), wImpl->width(), wImpl->height());
         adjustClipRegion(item, clippingRegion);
+        if (clippingRegion.isEmpty()) {
+            continue;
+        }
         effects->drawWindow(thumb, thumbMask, clippingRegion, thumbData);
     }
 }
 
-void Scene::paintDesktopThumbnails(Scene::Window *w)
+void Scene::paintDesktopThumbnails(Scene::Window *w, const QRegion &region)
 {
     EffectWindowImpl *wImpl = static_cast<EffectWindowImpl*>(effectWindow(w));
     for (QList<DesktopThumbnailItem*>::const_iterator it = wImpl->desktopThumbnails().constBegin();
@@ -573,8 +643,6 @@ void Scene::paintDesktopThumbnails(Scene::Window *w)
         if (!item->window()) {
             continue;
         }
-        s_recursionCheck = w;
-
         ScreenPaintData data;
         const QSize &screenSize = screens()->size();
         QSize size = screenSize;
@@ -585,10 +653,15 @@ void Scene::paintDesktopThumbnails(Scene::Window *w)
         const QPointF point = item->mapToScene(item->position());
         const qreal x = point.x() + w->x() + (item->width() - size.width())/2;
         const qreal y = point.y() + w->y() + (item->height() - size.height()) / 2;
-        const QRect region = QRect(x, y, item->width(), item->height());
-        QRegion clippingRegion = region;
+        // only the parts of the thumbnail being repainted, the desktop is not rendered at all if the
+        // host window got damaged elsewhere
+        QRegion clippingRegion = region & QRect(x, y, item->width(), item->height());
         clippingRegion &= QRegion(wImpl->x(), wImpl->y(), wImpl->width(), wImpl->height());
         adjustClipRegion(item, clippingRegion);
+        if (clippingRegion.isEmpty()) {
+            continue;
+        }
+        s_recursionCheck = w;
         data += QPointF(x, y);
         const int desktopMask = PAINT_SCREEN_TRANSFORMED | PAINT_WINDOW_TRANSFORMED | PAINT_SCREEN_BACKGROUND_FIRST;
         paintDesktop(item->desktop(), desktopMask, clippingRegion, data);
@@ -143,6 +143,12 @@ public:
 
     virtual void triggerFence();
 
+    /**
+     * Removes and returns the part of the repaints deferred for busy screens which lies
+     * in @p geometry. Called by the Compositor once the screen can take a new frame.
+     **/
+    QRegion takeDeferredRepaints(const QRect &geometry);
+
     virtual Decoration::Renderer *createDecorationRenderer(Decoration::DecoratedClientImpl *) = 0;
 
 public Q_SLOTS:
@@ -181,6 +187,18 @@ protected:
     virtual void paintDesktop(int desktop, int mask, const QRegion &region, ScreenPaintData &data);
     // compute time since the last repaint
     void updateTimeDiff();
+    // the damage united with the repaints of all windows in the stacking order, used with per
+    // screen rendering to find the screens which need a new frame
+    QRegion pendingRepaints(const QRegion &damage) const;
+    // with per screen rendering keeps the region of a screen which cannot take a new frame yet,
+    // it is painted once the screen completed its frame, see takeDeferredRepaints
+    void deferRepaint(const QRegion &region);
+    // the top most window on the screen with the given geometry if it covers the screen completely
+    // and could be shown without compositing, otherwise null. Never a window an effect changes
+    Toplevel *scanoutCandidate(const QRect &geometry) const;
+    // painting a screen resets the repaints of all windows, a frame which did not paint any
+    // screen has to reset them through this method
+    void resetWindowRepaints();
     // saved data for 2nd pass of optimized screen painting
     struct Phase2Data {
         Phase2Data(Window* w, QRegion r, QRegion c, int m, const WindowQuadList& q)
@@ -210,10 +228,12 @@ protected:
     QElapsedTimer last_time;
 private:
     void paintWindowThumbnails(Scene::Window *w, QRegion region, qreal opacity, qreal brightness, qreal saturation);
-    void paintDesktopThumbnails(Scene::Window *w);
+    void paintDesktopThumbnails(Scene::Window *w, const QRegion &region);
     QHash< Toplevel*, Window* > m_windows;
     // windows in their stacking order
     QVector< Window* > stacking_order;
+    // damage of screens which were busy with a frame when it got painted
+    QRegion m_deferredRepaints;
 };
 
 // The base class for windows representations in composite backends
@@ -375,6 +375,19 @@ bool OpenGLBackend::perScreenRendering() const
     return false;
 }
 
+bool OpenGLBackend::isScreenBusy(int screenId) const
+{
+    Q_UNUSED(screenId)
+    return false;
+}
+
+bool OpenGLBackend::directScanout(int screenId, Toplevel *toplevel)
+{
+    Q_UNUSED(screenId)
+    Q_UNUSED(toplevel)
+    return false;
+}
+
 /************************************************
  * SceneOpenGL
  ***********************************************/
@@ -668,8 +681,28 @@ qint64 SceneOpenGL::paint(QRegion damage, ToplevelList toplevels)
     if (m_backend->perScreenRendering()) {
         // trigger start render timer
         m_backend->prepareRenderingFrame();
+        // only screens with damage get a new frame, screens still presenting the previous
+        // frame are painted in a later pass
+        // The window repaints are collected once for the whole frame and passed to each screen
+        // as damage, as painting a screen resets them and the following screens would miss them.
+        const QRegion pending = pendingRepaints(damage);
+        QRegion deferred;
+        bool painted = false;
         for (int i = 0; i < screens()->count(); ++i) {
             const QRect &geo = screens()->geometry(i);
+            if (!pending.intersects(geo)) {
+                continue;
+            }
+            if (m_backend->isScreenBusy(i)) {
+                deferred |= pending & geo;
+                continue;
+            }
+            if (Toplevel *candidate = scanoutCandidate(geo)) {
+                if (m_backend->directScanout(i, candidate)) {
+                    continue;
+                }
+            }
+            painted = true;
             QRegion update;
             QRegion valid;
             // prepare rendering makes context current on the output
@@ -682,7 +715,7 @@ qint64 SceneOpenGL::paint(QRegion damage, ToplevelList toplevels)
             }
 
             int mask = 0;
-            paintScreen(&mask, damage.intersected(geo), repaint, &update, &valid);   // call generic implementation
+            paintScreen(&mask, pending.intersected(geo), repaint, &update, &valid);   // call generic implementation
 
             GLVertexBuffer::streamingBuffer()->endOfFrame();
 
@@ -690,6 +723,10 @@ qint64 SceneOpenGL::paint(QRegion damage, ToplevelList toplevels)
 
             GLVertexBuffer::streamingBuffer()->framePosted();
         }
+        if (!painted) {
+            resetWindowRepaints();
+        }
+        deferRepaint(deferred);
     } else {
         m_backend->makeCurrent();
         QRegion repaint = m_backend->prepareRenderingFrame();
@@ -410,6 +410,20 @@ public:
      **/
     virtual bool perScreenRendering() const;
     virtual QRegion prepareRenderingForScreen(int screenId);
+    /**
+     * Whether the screen with @p screenId cannot take a new frame yet, e.g. because the
+     * previous frame is still waiting to be presented. Only used with per screen rendering.
+     * Default implementation returns @c false.
+     **/
+    virtual bool isScreenBusy(int screenId) const;
+    /**
+     * Tries to show the buffer of @p toplevel on the screen with @p screenId directly, without
+     * compositing the screen. Only used with per screen rendering for a window covering the
+     * whole screen.
+     * Default implementation returns @c false.
+     * @returns Whether the buffer is shown directly.
+     **/
+    virtual bool directScanout(int screenId, Toplevel *toplevel);
     /**
      * @brief Compositor is going into idle mode, flushes any pending paints.
      **/
@@ -18,6 +18,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "scene_qpainter.h"
+#include "scene_qpainter_displaylist.h"
 // KWin
 #include "client.h"
 #include "composite.h"
@@ -85,6 +86,17 @@ bool QPainterBackend::perScreenRendering() const
     return false;
 }
 
+void QPainterBackend::prepareRenderingForScreen(int screenId)
+{
+    Q_UNUSED(screenId)
+}
+
+bool QPainterBackend::isScreenBusy(int screenId) const
+{
+    Q_UNUSED(screenId)
+    return false;
+}
+
 QImage *QPainterBackend::bufferForScreen(int screenId)
 {
     Q_UNUSED(screenId)
@@ -116,7 +128,13 @@ SceneQPainter::SceneQPainter(QPainterBackend *backend, QObject *parent)
     : Scene(parent)
     , m_backend(backend)
     , m_painter(new QPainter())
+    , m_shmFetcher(kwinApp()->shouldUseWaylandForCompositing() ? nullptr : new QPainterShmFetcher)
 {
+    const int threads = qgetenv("KWIN_QPAINTER_THREADS").toInt();
+    if (threads > 1) {
+        qCDebug(KWIN_CORE) << "Painting QPainter scene on" << threads << "threads";
+        m_displayList.reset(new QPainterDisplayList(threads));
+    }
 }
 
 SceneQPainter::~SceneQPainter()
@@ -148,23 +166,40 @@ qint64 SceneQPainter::paint(QRegion damage, ToplevelList toplevels)
     renderTimer.start();
 
     createStackingOrder(toplevels);
+    fetchWindowPixmaps(toplevels);
 
     int mask = 0;
     m_backend->prepareRenderingFrame();
     if (m_backend->perScreenRendering()) {
         const bool needsFullRepaint = m_backend->needsFullRepaint();
+        // only screens with damage get a new frame, screens still presenting the previous
+        // frame are painted in a later pass
+        // The window repaints are collected once for the whole frame and passed to each screen
+        // as damage, as painting a screen resets them and the following screens would miss them.
+        const QRegion pending = pendingRepaints(damage);
+        QRegion deferred;
         if (needsFullRepaint) {
             mask |= Scene::PAINT_SCREEN_BACKGROUND_FIRST;
             damage = screens()->geometry();
+        } else {
+            damage = pending;
         }
         QRegion overallUpdate;
         for (int i = 0; i < screens()->count(); ++i) {
             const QRect geometry = screens()->geometry(i);
+            if (!pending.intersects(geometry)) {
+                continue;
+            }
+            if (m_backend->isScreenBusy(i)) {
+                deferred |= pending & geometry;
+                continue;
+            }
+            m_backend->prepareRenderingForScreen(i);
             QImage *buffer = m_backend->bufferForScreen(i);
             if (!buffer || buffer->isNull()) {
                 continue;
             }
-            m_painter->begin(buffer);
+            beginPainting(buffer);
             m_painter->save();
             m_painter->setWindow(geometry);
 
@@ -173,12 +208,13 @@ qint64 SceneQPainter::paint(QRegion damage, ToplevelList toplevels)
             overallUpdate = overallUpdate.united(updateRegion);
 
             m_painter->restore();
-            m_painter->end();
+            endPainting(buffer, updateRegion.translated(-geometry.topLeft()));
         }
+        deferRepaint(deferred);
         m_backend->showOverlay();
         m_backend->present(mask, overallUpdate);
     } else {
-        m_painter->begin(m_backend->buffer());
+        beginPainting(m_backend->buffer());
         if (m_backend->needsFullRepaint()) {
             mask |= Scene::PAINT_SCREEN_BACKGROUND_FIRST;
             damage = QRegion(0, 0, displayWidth(), displayHeight());
@@ -186,10 +222,13 @@ qint64 SceneQPainter::paint(QRegion damage, ToplevelList toplevels)
         QRegion updateRegion, validRegion;
         paintScreen(&mask, damage, QRegion(), &updateRegion, &validRegion);
 
+        endPainting(m_backend->buffer(), updateRegion);
+        // the cursor is painted directly as it can be outside of the update region
+        m_painter->begin(m_backend->buffer());
         m_backend->renderCursor(m_painter.data());
+        m_painter->end();
         m_backend->showOverlay();
 
-        m_painter->end();
         m_backend->present(mask, updateRegion);
     }
 
@@ -199,6 +238,44 @@ qint64 SceneQPainter::paint(QRegion damage, ToplevelList toplevels)
     return renderTimer.nsecsElapsed();
 }
 
+void SceneQPainter::beginPainting(QImage *buffer)
+{
+    if (m_displayList) {
+        m_displayList->reset(buffer);
+        m_painter->begin(m_displayList.data());
+    } else {
+        m_painter->begin(buffer);
+    }
+}
+
+void SceneQPainter::endPainting(QImage *buffer, const QRegion &updateRegion)
+{
+    m_painter->end();
+    if (m_displayList) {
+        m_displayList->replay(buffer, updateRegion);
+    }
+}
+
+void SceneQPainter::fetchWindowPixmaps(const ToplevelList &toplevels)
+{
+    if (!m_shmFetcher) {
+        return;
+    }
+    // request the damaged areas of all windows before painting starts instead of waiting for
+    // each window when it gets painted
+    for (auto it = toplevels.constBegin(); it != toplevels.constEnd(); ++it) {
+        Toplevel *t = *it;
+        if (t->damage().isEmpty() || !t->effectWindow()) {
+            continue;
+        }
+        Window *w = static_cast<Window*>(t->effectWindow()->sceneWindow());
+        if (w && w->isPaintingEnabled()) {
+            w->updatePixmap();
+        }
+    }
+    m_shmFetcher->flush();
+}
+
 void SceneQPainter::paintBackground(QRegion region)
 {
     m_painter->setBrush(Qt::black);
@@ -252,8 +329,11 @@ void SceneQPainter::Window::performPaint(int mask, QRegion region, WindowPaintDa
         return;
     }
     if (!toplevel->damage().isEmpty()) {
-        pixmap->update(toplevel->damage());
-        toplevel->resetDamage();
+        // damage which arrived after SceneQPainter::fetchWindowPixmaps
+        updatePixmap();
+        if (QPainterShmFetcher *fetcher = m_scene->shmFetcher()) {
+            fetcher->flush();
+        }
     }
 
     QPainter *scenePainter = m_scene->painter();
@@ -269,16 +349,31 @@ void SceneQPainter::Window::performPaint(int mask, QRegion region, WindowPaintDa
     }
 
     const bool opaque = qFuzzyCompare(1.0, data.opacity());
-    QImage tempImage;
-    QPainter tempPainter;
-    if (!opaque) {
-        // need a temp render target which we later on blit to the screen
-        tempImage = QImage(toplevel->visibleRect().size(), QImage::Format_ARGB32_Premultiplied);
-        tempImage.fill(Qt::transparent);
-        tempPainter.begin(&tempImage);
-        tempPainter.save();
-        tempPainter.translate(toplevel->geometry().topLeft() - toplevel->visibleRect().topLeft());
-        painter = &tempPainter;
+    // shadow, decoration and content can be drawn translucent one by one as long as they do not
+    // overlap, otherwise they have to be combined in a layer first
+    const bool useLayer = !opaque && shadowOverlapsWindow();
+    QPainter layerPainter;
+    if (useLayer) {
+        // the layer is kept for the following frames, e.g. while the window fades
+        const QSize layerSize = toplevel->visibleRect().size();
+        if (m_layer.size() != layerSize) {
+            m_layer = QImage(layerSize, QImage::Format_ARGB32_Premultiplied);
+        }
+        layerPainter.begin(&m_layer);
+        if (!(mask & (PAINT_WINDOW_TRANSFORMED | PAINT_SCREEN_TRANSFORMED))) {
+            // only the part of the layer within the painted region gets updated
+            layerPainter.setClipRegion(region.translated(-toplevel->visibleRect().topLeft()));
+        }
+        layerPainter.setCompositionMode(QPainter::CompositionMode_Source);
+        layerPainter.fillRect(m_layer.rect(), Qt::transparent);
+        layerPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        layerPainter.translate(toplevel->geometry().topLeft() - toplevel->visibleRect().topLeft());
+        painter = &layerPainter;
+    } else {
+        if (!opaque) {
+            painter->setOpacity(data.opacity());
+        }
+        m_layer = QImage();
     }
     renderShadow(painter);
     renderWindowDecorations(painter);
@@ -287,15 +382,11 @@ void SceneQPainter::Window::performPaint(int mask, QRegion region, WindowPaintDa
     const QRect src = QRect(toplevel->clientPos(), toplevel->clientSize());
     painter->drawImage(toplevel->clientPos(), pixmap->image(), src);
 
-    if (!opaque) {
-        tempPainter.restore();
-        tempPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-        QColor translucent(Qt::transparent);
-        translucent.setAlphaF(data.opacity());
-        tempPainter.fillRect(QRect(QPoint(0, 0), toplevel->visibleRect().size()), translucent);
-        tempPainter.end();
+    if (useLayer) {
+        layerPainter.end();
         painter = scenePainter;
-        painter->drawImage(toplevel->visibleRect().topLeft() - toplevel->geometry().topLeft(), tempImage);
+        painter->setOpacity(data.opacity());
+        painter->drawImage(toplevel->visibleRect().topLeft() - toplevel->geometry().topLeft(), m_layer);
     }
 
     painter->restore();
@@ -304,6 +395,34 @@ void SceneQPainter::Window::performPaint(int mask, QRegion region, WindowPaintDa
     painter->setClipping(false);
 }
 
+bool SceneQPainter::Window::shadowOverlapsWindow() const
+{
+    if (!toplevel->shadow()) {
+        return false;
+    }
+    const SceneQPainterShadow *shadow = static_cast<const SceneQPainterShadow*>(toplevel->shadow());
+    const int leftOffset   = shadow->leftOffset();
+    const int topOffset    = shadow->topOffset();
+    const int rightOffset  = shadow->rightOffset();
+    const int bottomOffset = shadow->bottomOffset();
+    const auto size = [shadow] (SceneQPainterShadow::ShadowElements element) {
+        return shadow->shadowPixmap(element).size();
+    };
+    // the elements reach below the window if they are larger than the offsets they are drawn at
+    const QSize topLeft = size(SceneQPainterShadow::ShadowElementTopLeft);
+    const QSize topRight = size(SceneQPainterShadow::ShadowElementTopRight);
+    const QSize bottomLeft = size(SceneQPainterShadow::ShadowElementBottomLeft);
+    const QSize bottomRight = size(SceneQPainterShadow::ShadowElementBottomRight);
+    return topLeft.width() > leftOffset || topLeft.height() > topOffset ||
+           topRight.width() > rightOffset || topRight.height() > topOffset ||
+           bottomLeft.width() > leftOffset || bottomLeft.height() > bottomOffset ||
+           bottomRight.width() > rightOffset || bottomRight.height() > bottomOffset ||
+           size(SceneQPainterShadow::ShadowElementTop).height() > topOffset ||
+           size(SceneQPainterShadow::ShadowElementBottom).height() > bottomOffset ||
+           size(SceneQPainterShadow::ShadowElementLeft).width() > leftOffset ||
+           size(SceneQPainterShadow::ShadowElementRight).width() > rightOffset;
+}
+
 void SceneQPainter::Window::renderShadow(QPainter* painter)
 {
     if (!toplevel->shadow()) {
@@ -393,9 +512,22 @@ void SceneQPainter::Window::renderWindowDecorations(QPainter *painter)
     painter->drawImage(dbr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom));
 }
 
+void SceneQPainter::Window::updatePixmap()
+{
+    if (toplevel->damage().isEmpty()) {
+        return;
+    }
+    QPainterWindowPixmap *pixmap = windowPixmap<QPainterWindowPixmap>();
+    if (!pixmap || !pixmap->isValid()) {
+        return;
+    }
+    pixmap->update(toplevel->damage());
+    toplevel->resetDamage();
+}
+
 WindowPixmap *SceneQPainter::Window::createWindowPixmap()
 {
-    return new QPainterWindowPixmap(this);
+    return new QPainterWindowPixmap(this, m_scene->shmFetcher());
 }
 
 Decoration::Renderer *SceneQPainter::createDecorationRenderer(Decoration::DecoratedClientImpl *impl)
@@ -406,9 +538,9 @@ Decoration::Renderer *SceneQPainter::createDecorationRenderer(Decoration::Decora
 //****************************************
 // QPainterWindowPixmap
 //****************************************
-QPainterWindowPixmap::QPainterWindowPixmap(Scene::Window *window)
+QPainterWindowPixmap::QPainterWindowPixmap(Scene::Window *window, QPainterShmFetcher *fetcher)
     : WindowPixmap(window)
-    , m_shm(kwinApp()->shouldUseWaylandForCompositing() ? nullptr : new Xcb::Shm)
+    , m_fetcher(fetcher)
 {
 }
 
@@ -421,7 +553,7 @@ void QPainterWindowPixmap::create()
     if (isValid()) {
         return;
     }
-    if (!kwinApp()->shouldUseWaylandForCompositing() && !m_shm->isValid()) {
+    if (!kwinApp()->shouldUseWaylandForCompositing() && (!m_fetcher || !m_fetcher->isValid())) {
         return;
     }
     KWin::WindowPixmap::create();
@@ -435,7 +567,9 @@ void QPainterWindowPixmap::create()
         return;
     }
 #endif
-    m_image = QImage((uchar*)m_shm->buffer(), size().width(), size().height(), QImage::Format_ARGB32_Premultiplied);
+    m_image = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+    m_fetcher->fetch(pixmap(), m_image.rect(), &m_image);
+    m_fetcher->flush();
 }
 
 bool QPainterWindowPixmap::update(const QRegion &damage)
@@ -458,20 +592,88 @@ bool QPainterWindowPixmap::update(const QRegion &damage)
     }
 #endif
 
-    if (!m_shm->isValid()) {
+    if (!m_fetcher || !m_fetcher->isValid()) {
         return false;
     }
+    const QRect bounds = m_image.rect();
+    for (const QRect &rect : damage.rects()) {
+        const QRect r = rect & bounds;
+        if (!r.isEmpty()) {
+            m_fetcher->fetch(pixmap(), r, &m_image);
+        }
+    }
+    return true;
+}
 
-    // TODO: optimize by only updating the damaged areas
-    xcb_shm_get_image_cookie_t cookie = xcb_shm_get_image_unchecked(connection(), pixmap(),
-        0, 0, size().width(), size().height(),
-        ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, m_shm->segment(), 0);
+//****************************************
+// QPainterShmFetcher
+//****************************************
+QPainterShmFetcher::QPainterShmFetcher()
+{
+    m_segments << new Xcb::Shm;
+}
 
-    ScopedCPointer<xcb_shm_get_image_reply_t> image(xcb_shm_get_image_reply(connection(), cookie, NULL));
-    if (image.isNull()) {
-        return false;
+QPainterShmFetcher::~QPainterShmFetcher()
+{
+    qDeleteAll(m_segments);
+}
+
+bool QPainterShmFetcher::isValid() const
+{
+    return m_segments.first()->isValid();
+}
+
+void QPainterShmFetcher::fetch(xcb_pixmap_t pixmap, const QRect &rect, QImage *target)
+{
+    const quint32 bytes = rect.width() * rect.height() * 4;
+    if (bytes > quint32(Xcb::Shm::size())) {
+        qCWarning(KWIN_CORE) << "Pixmap area too large for SHM segment:" << rect;
+        return;
     }
-    return true;
+    if (m_offset + bytes > quint32(Xcb::Shm::size())) {
+        m_segment++;
+        m_offset = 0;
+        if (m_segment == m_segments.count()) {
+            Xcb::Shm *shm = new Xcb::Shm;
+            if (!shm->isValid()) {
+                delete shm;
+                // wait for the pending requests to free the existing segments
+                flush();
+            } else {
+                m_segments << shm;
+            }
+        }
+    }
+    Request request;
+    request.cookie = xcb_shm_get_image_unchecked(connection(), pixmap,
+        rect.x(), rect.y(), rect.width(), rect.height(),
+        ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, m_segments.at(m_segment)->segment(), m_offset);
+    request.segment = m_segment;
+    request.offset = m_offset;
+    request.rect = rect;
+    request.target = target;
+    m_requests << request;
+    m_offset += bytes;
+}
+
+void QPainterShmFetcher::flush()
+{
+    for (auto it = m_requests.constBegin(); it != m_requests.constEnd(); ++it) {
+        const Request &request = *it;
+        ScopedCPointer<xcb_shm_get_image_reply_t> image(xcb_shm_get_image_reply(connection(), request.cookie, NULL));
+        if (image.isNull()) {
+            continue;
+        }
+        const uchar *source = reinterpret_cast<const uchar*>(m_segments.at(request.segment)->buffer()) + request.offset;
+        const int sourceStride = request.rect.width() * 4;
+        for (int y = 0; y < request.rect.height(); ++y) {
+            memcpy(request.target->scanLine(request.rect.y() + y) + request.rect.x() * 4,
+                   source + y * sourceStride, sourceStride);
+        }
+    }
+    m_requests.clear();
+    m_segment = 0;
+    m_offset = 0;
 }
 
 QPainterEffectFrame::QPainterEffectFrame(EffectFrameImpl *frame, SceneQPainter *scene)
@@ -25,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "decorations/decorationrenderer.h"
 
+#include <xcb/shm.h>
+
 namespace KWin {
 
 namespace Xcb {
@@ -90,6 +92,18 @@ public:
      * Default implementation returns @c false.
      **/
     virtual bool perScreenRendering() const;
+    /**
+     * Called before the screen with @p screenId gets painted in per screen rendering.
+     * Screens without damage are not painted and this method is not called for them.
+     * Default implementation does nothing.
+     **/
+    virtual void prepareRenderingForScreen(int screenId);
+    /**
+     * Whether the screen with @p screenId cannot take a new frame yet, e.g. because the
+     * previous frame is still waiting to be presented. Only used with per screen rendering.
+     * Default implementation returns @c false.
+     **/
+    virtual bool isScreenBusy(int screenId) const;
 
 protected:
     QPainterBackend();
@@ -107,6 +121,9 @@ private:
     bool m_failed;
 };
 
+class QPainterDisplayList;
+class QPainterShmFetcher;
+
 class SceneQPainter : public Scene
 {
     Q_OBJECT
@@ -125,6 +142,10 @@ public:
     void screenGeometryChanged(const QSize &size) override;
 
     QPainter *painter();
+    /**
+     * The fetcher for the contents of X11 window pixmaps, @c null on Wayland.
+     **/
+    QPainterShmFetcher *shmFetcher();
 
     static SceneQPainter *createScene(QObject *parent);
 
@@ -134,8 +155,14 @@ protected:
 
 private:
     explicit SceneQPainter(QPainterBackend *backend, QObject *parent = nullptr);
+    void fetchWindowPixmaps(const ToplevelList &toplevels);
+    void beginPainting(QImage *buffer);
+    void endPainting(QImage *buffer, const QRegion &updateRegion);
     QScopedPointer<QPainterBackend> m_backend;
     QScopedPointer<QPainter> m_painter;
+    QScopedPointer<QPainterShmFetcher> m_shmFetcher;
+    // records the painting to replay it on several threads, null if painting on the main thread
+    QScopedPointer<QPainterDisplayList> m_displayList;
     class Window;
 };
 
@@ -145,28 +172,77 @@ public:
     Window(SceneQPainter *scene, Toplevel *c);
     virtual ~Window();
     virtual void performPaint(int mask, QRegion region, WindowPaintData data) override;
+    /**
+     * Queues the update of the window pixmap with the damage of the window.
+     * The update is finished once the QPainterShmFetcher gets flushed.
+     **/
+    void updatePixmap();
 protected:
     virtual WindowPixmap *createWindowPixmap() override;
 private:
     void renderShadow(QPainter *painter);
     void renderWindowDecorations(QPainter *painter);
+    bool shadowOverlapsWindow() const;
     SceneQPainter *m_scene;
+    // combines shadow, decoration and content of a translucent window
+    QImage m_layer;
 };
 
 class QPainterWindowPixmap : public WindowPixmap
 {
 public:
-    explicit QPainterWindowPixmap(Scene::Window *window);
+    QPainterWindowPixmap(Scene::Window *window, QPainterShmFetcher *fetcher);
     virtual ~QPainterWindowPixmap();
     virtual void create() override;
 
+    /**
+     * Updates the @p damage of the image. On X11 the damaged areas are only queued in the
+     * QPainterShmFetcher and the image is up to date after it got flushed.
+     **/
     bool update(const QRegion &damage);
     const QImage &image();
 private:
-    QScopedPointer<Xcb::Shm> m_shm;
+    QPainterShmFetcher *m_fetcher;
     QImage m_image;
 };
 
+/**
+ * @brief Copies areas of X11 pixmaps into QImages through shared memory.
+ *
+ * Each area is requested with xcb_shm_get_image into a shared memory segment. All requests are
+ * sent before the first reply is waited for, so that the X server processes them in one go.
+ * The segments are shared by all windows and get reused for every frame; more segments are only
+ * created if the requested areas do not fit into the existing ones.
+ **/
+class QPainterShmFetcher
+{
+public:
+    QPainterShmFetcher();
+    ~QPainterShmFetcher();
+    bool isValid() const;
+    /**
+     * Queues copying the @p rect of @p pixmap to the same position in @p target.
+     * The @p target has to stay valid until the next flush.
+     **/
+    void fetch(xcb_pixmap_t pixmap, const QRect &rect, QImage *target);
+    /**
+     * Waits for all queued requests and copies the results into the target images.
+     **/
+    void flush();
+private:
+    struct Request {
+        xcb_shm_get_image_cookie_t cookie;
+        int segment;
+        quint32 offset;
+        QRect rect;
+        QImage *target;
+    };
+    QVector<Xcb::Shm*> m_segments;
+    QVector<Request> m_requests;
+    int m_segment = 0;
+    quint32 m_offset = 0;
+};
+
 class QPainterEffectFrame : public Scene::EffectFrame
 {
 public:
@@ -249,6 +325,12 @@ QPainter* SceneQPainter::painter()
     return m_painter.data();
 }
 
+inline
+QPainterShmFetcher *SceneQPainter::shmFetcher()
+{
+    return m_shmFetcher.data();
+}
+
 inline
 const QImage &QPainterWindowPixmap::image()
 {
@@ -0,0 +1,347 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "scene_qpainter_displaylist.h"
+
+#include <QRunnable>
+
+#include <functional>
+
+namespace KWin
+{
+
+// bands are not made smaller than this to keep the per band overhead low
+static const int s_minimumBandHeight = 32;
+
+//****************************************
+// QPainterDisplayList
+//****************************************
+QPainterDisplayList::QPainterDisplayList(int threads)
+    : QPaintDevice()
+    , m_engine(new QPainterDisplayListEngine(this))
+{
+    m_pool.setMaxThreadCount(threads);
+}
+
+QPainterDisplayList::~QPainterDisplayList() = default;
+
+QPaintEngine *QPainterDisplayList::paintEngine() const
+{
+    return m_engine.data();
+}
+
+int QPainterDisplayList::metric(PaintDeviceMetric metric) const
+{
+    switch (metric) {
+    case PdmWidth:
+        return m_size.width();
+    case PdmHeight:
+        return m_size.height();
+    case PdmWidthMM:
+        return qRound(m_size.width() * 25.4 / m_dpiX);
+    case PdmHeightMM:
+        return qRound(m_size.height() * 25.4 / m_dpiY);
+    case PdmNumColors:
+        return 0;
+    case PdmDepth:
+        return m_depth;
+    case PdmDpiX:
+    case PdmPhysicalDpiX:
+        return m_dpiX;
+    case PdmDpiY:
+    case PdmPhysicalDpiY:
+        return m_dpiY;
+    case PdmDevicePixelRatio:
+        return 1;
+    default:
+        return QPaintDevice::metric(metric);
+    }
+}
+
+void QPainterDisplayList::reset(const QImage *target)
+{
+    m_commands.clear();
+    m_size = target->size();
+    m_depth = target->depth();
+    m_dpiX = target->logicalDpiX();
+    m_dpiY = target->logicalDpiY();
+}
+
+class QPainterDisplayListBand : public QRunnable
+{
+public:
+    QPainterDisplayListBand(std::function<void()> paint)
+        : m_paint(paint)
+    {
+    }
+    void run() override {
+        m_paint();
+    }
+private:
+    std::function<void()> m_paint;
+};
+
+void QPainterDisplayList::replay(QImage *target, const QRegion &region)
+{
+    const QRect bounds = region.boundingRect() & target->rect();
+    if (!bounds.isEmpty() && !m_commands.isEmpty()) {
+        // detach once on this thread, the bands only use the raw memory
+        uchar *bits = target->bits();
+        const int bandCount = qMax(1, qMin(m_pool.maxThreadCount() * 2, bounds.height() / s_minimumBandHeight));
+        const int bandHeight = (bounds.height() + bandCount - 1) / bandCount;
+        for (int y = bounds.top(); y <= bounds.bottom(); y += bandHeight) {
+            const QRect band = QRect(bounds.left(), y, bounds.width(), bandHeight) & bounds;
+            if (!region.intersects(band)) {
+                continue;
+            }
+            m_pool.start(new QPainterDisplayListBand([this, target, bits, band] {
+                paintBand(target, bits, band);
+            }));
+        }
+        m_pool.waitForDone();
+    }
+    m_commands.clear();
+}
+
+void QPainterDisplayList::paintBand(QImage *target, uchar *bits, const QRect &band) const
+{
+    QImage image(bits + band.y() * target->bytesPerLine() + band.x() * target->depth() / 8,
+                 band.width(), band.height(), target->bytesPerLine(), target->format());
+    const QTransform offset = QTransform::fromTranslate(-band.x(), -band.y());
+    QPainter p(&image);
+    for (auto it = m_commands.constBegin(); it != m_commands.constEnd(); ++it) {
+        const Command &c = *it;
+        switch (c.type) {
+        case Command::Type::State:
+            p.setTransform(c.transform * offset);
+            p.setPen(c.pen);
+            p.setBrush(c.brush);
+            p.setBrushOrigin(c.brushOrigin);
+            p.setBackground(c.background);
+            p.setBackgroundMode(c.backgroundMode);
+            p.setRenderHints(p.renderHints(), false);
+            p.setRenderHints(c.renderHints, true);
+            p.setCompositionMode(c.compositionMode);
+            p.setOpacity(c.opacity);
+            break;
+        case Command::Type::ClipEnabled:
+            p.setClipping(c.clipEnabled);
+            break;
+        case Command::Type::ClipRegion:
+            p.setClipRegion(c.clipRegion, c.clipOperation);
+            break;
+        case Command::Type::ClipPath:
+            p.setClipPath(c.path, c.clipOperation);
+            break;
+        case Command::Type::Image:
+            p.drawImage(c.rect, c.image, c.source, c.imageFlags);
+            break;
+        case Command::Type::TiledImage:
+            // equivalent of drawTiledPixmap, which only takes a QPixmap
+            p.save();
+            p.setBrushOrigin(c.rect.topLeft() - c.point);
+            p.fillRect(c.rect, QBrush(c.image));
+            p.restore();
+            break;
+        case Command::Type::Path:
+            p.drawPath(c.path);
+            break;
+        case Command::Type::Polygon:
+            switch (c.polygonMode) {
+            case QPaintEngine::PolylineMode:
+                p.drawPolyline(c.polygon);
+                break;
+            case QPaintEngine::WindingMode:
+                p.drawPolygon(c.polygon, Qt::WindingFill);
+                break;
+            case QPaintEngine::ConvexMode:
+                p.drawConvexPolygon(c.polygon);
+                break;
+            default:
+                p.drawPolygon(c.polygon, Qt::OddEvenFill);
+                break;
+            }
+            break;
+        case Command::Type::Rects:
+            p.drawRects(c.rects);
+            break;
+        }
+    }
+}
+
+//****************************************
+// QPainterDisplayListEngine
+//****************************************
+QPainterDisplayListEngine::QPainterDisplayListEngine(QPainterDisplayList *list)
+    : QPaintEngine(QPaintEngine::AllFeatures)
+    , m_list(list)
+{
+    m_state.type = QPainterDisplayList::Command::Type::State;
+}
+
+QPainterDisplayListEngine::~QPainterDisplayListEngine() = default;
+
+bool QPainterDisplayListEngine::begin(QPaintDevice *device)
+{
+    Q_UNUSED(device)
+    return true;
+}
+
+bool QPainterDisplayListEngine::end()
+{
+    return true;
+}
+
+QPaintEngine::Type QPainterDisplayListEngine::type() const
+{
+    return QPaintEngine::User;
+}
+
+void QPainterDisplayListEngine::updateState(const QPaintEngineState &state)
+{
+    typedef QPainterDisplayList::Command Command;
+    const DirtyFlags flags = state.state();
+    if (flags & (DirtyTransform | DirtyPen | DirtyBrush | DirtyBrushOrigin | DirtyBackground |
+                 DirtyBackgroundMode | DirtyHints | DirtyCompositionMode | DirtyOpacity)) {
+        if (flags & DirtyTransform) {
+            m_state.transform = state.transform();
+        }
+        if (flags & DirtyPen) {
+            m_state.pen = state.pen();
+            m_state.pen.setBrush(toImageBrush(m_state.pen.brush()));
+        }
+        if (flags & DirtyBrush) {
+            m_state.brush = toImageBrush(state.brush());
+        }
+        if (flags & DirtyBrushOrigin) {
+            m_state.brushOrigin = state.brushOrigin();
+        }
+        if (flags & DirtyBackground) {
+            m_state.background = toImageBrush(state.backgroundBrush());
+        }
+        if (flags & DirtyBackgroundMode) {
+            m_state.backgroundMode = state.backgroundMode();
+        }
+        if (flags & DirtyHints) {
+            m_state.renderHints = state.renderHints();
+        }
+        if (flags & DirtyCompositionMode) {
+            m_state.compositionMode = state.compositionMode();
+        }
+        if (flags & DirtyOpacity) {
+            m_state.opacity = state.opacity();
+        }
+        m_list->m_commands << m_state;
+    }
+    // the clip is given in the coordinates of the transform recorded above
+    if (flags & DirtyClipRegion) {
+        Command c;
+        c.type = Command::Type::ClipRegion;
+        c.clipRegion = state.clipRegion();
+        c.clipOperation = state.clipOperation();
+        m_list->m_commands << c;
+    }
+    if (flags & DirtyClipPath) {
+        Command c;
+        c.type = Command::Type::ClipPath;
+        c.path = state.clipPath();
+        c.clipOperation = state.clipOperation();
+        m_list->m_commands << c;
+    }
+    if (flags & DirtyClipEnabled) {
+        Command c;
+        c.type = Command::Type::ClipEnabled;
+        c.clipEnabled = state.isClipEnabled();
+        m_list->m_commands << c;
+    }
+}
+
+void QPainterDisplayListEngine::drawImage(const QRectF &rect, const QImage &image, const QRectF &sr, Qt::ImageConversionFlags flags)
+{
+    QPainterDisplayList::Command c;
+    c.type = QPainterDisplayList::Command::Type::Image;
+    c.rect = rect;
+    c.image = image;
+    c.source = sr;
+    c.imageFlags = flags;
+    m_list->m_commands << c;
+}
+
+void QPainterDisplayListEngine::drawPixmap(const QRectF &rect, const QPixmap &pixmap, const QRectF &sr)
+{
+    QPainterDisplayList::Command c;
+    c.type = QPainterDisplayList::Command::Type::Image;
+    c.rect = rect;
+    c.image = pixmap.toImage();
+    c.source = sr;
+    m_list->m_commands << c;
+}
+
+void QPainterDisplayListEngine::drawTiledPixmap(const QRectF &rect, const QPixmap &pixmap, const QPointF &offset)
+{
+    QPainterDisplayList::Command c;
+    c.type = QPainterDisplayList::Command::Type::TiledImage;
+    c.rect = rect;
+    c.image = pixmap.toImage();
+    c.point = offset;
+    m_list->m_commands << c;
+}
+
+QBrush QPainterDisplayListEngine::toImageBrush(const QBrush &brush)
+{
+    if (brush.style() != Qt::TexturePattern) {
+        return brush;
+    }
+    QBrush imageBrush = brush;
+    imageBrush.setTextureImage(brush.textureImage());
+    return imageBrush;
+}
+
+void QPainterDisplayListEngine::drawPath(const QPainterPath &path)
+{
+    QPainterDisplayList::Command c;
+    c.type = QPainterDisplayList::Command::Type::Path;
+    c.path = path;
+    m_list->m_commands << c;
+}
+
+void QPainterDisplayListEngine::drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode)
+{
+    QPainterDisplayList::Command c;
+    c.type = QPainterDisplayList::Command::Type::Polygon;
+    c.polygon.reserve(pointCount);
+    for (int i = 0; i < pointCount; ++i) {
+        c.polygon << points[i];
+    }
+    c.polygonMode = mode;
+    m_list->m_commands << c;
+}
+
+void QPainterDisplayListEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    QPainterDisplayList::Command c;
+    c.type = QPainterDisplayList::Command::Type::Rects;
+    c.rects.reserve(rectCount);
+    for (int i = 0; i < rectCount; ++i) {
+        c.rects << rects[i];
+    }
+    m_list->m_commands << c;
+}
+
+}
@@ -0,0 +1,162 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_SCENE_QPAINTER_DISPLAYLIST_H
+#define KWIN_SCENE_QPAINTER_DISPLAYLIST_H
+
+#include <QBrush>
+#include <QImage>
+#include <QPaintDevice>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QPixmap>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QTransform>
+#include <QVector>
+
+namespace KWin
+{
+
+class QPainterDisplayListEngine;
+
+/**
+ * @brief Paint device recording the painting of a frame to replay it on several threads.
+ *
+ * The scene, including the effects, paints into the QPainterDisplayList on the main thread. This
+ * only records the painter state changes and the drawing commands, images are kept as shallow
+ * copies. QPixmaps must not be used outside of the GUI thread, so pixmaps, including brush
+ * textures, are converted to QImages while recording. Afterwards replay splits the updated area of the target image into horizontal
+ * bands and paints the recorded commands into each band on a thread pool. Each band is painted
+ * through a QImage referencing the band's part of the target, so the threads never touch the
+ * same pixels.
+ *
+ * The recording references the images of the window pixmaps, it has to be cleared before they
+ * get updated again to not cause a deep copy.
+ **/
+class QPainterDisplayList : public QPaintDevice
+{
+public:
+    /**
+     * Creates a display list replaying on up to @p threads threads.
+     **/
+    explicit QPainterDisplayList(int threads);
+    virtual ~QPainterDisplayList();
+
+    /**
+     * Starts a new recording for painting on @p target. Only the metrics of @p target are used.
+     **/
+    void reset(const QImage *target);
+    /**
+     * Paints the recorded commands on @p target, restricted to the bands intersecting @p region,
+     * and clears the recording. Returns once all bands are painted.
+     **/
+    void replay(QImage *target, const QRegion &region);
+
+    QPaintEngine *paintEngine() const override;
+
+protected:
+    int metric(PaintDeviceMetric metric) const override;
+
+private:
+    friend class QPainterDisplayListEngine;
+    struct Command {
+        enum class Type {
+            State,
+            ClipEnabled,
+            ClipRegion,
+            ClipPath,
+            Image,
+            TiledImage,
+            Path,
+            Polygon,
+            Rects
+        };
+        Type type;
+        // State
+        QTransform transform;
+        QPen pen;
+        QBrush brush;
+        QPointF brushOrigin;
+        QBrush background;
+        Qt::BGMode backgroundMode = Qt::TransparentMode;
+        QPainter::RenderHints renderHints;
+        QPainter::CompositionMode compositionMode = QPainter::CompositionMode_SourceOver;
+        qreal opacity = 1.0;
+        // ClipEnabled, ClipRegion and ClipPath
+        bool clipEnabled = false;
+        Qt::ClipOperation clipOperation = Qt::NoClip;
+        QRegion clipRegion;
+        // ClipPath and Path
+        QPainterPath path;
+        // Image and TiledImage
+        QRectF rect;
+        QRectF source;
+        QImage image;
+        Qt::ImageConversionFlags imageFlags;
+        // TiledImage offset
+        QPointF point;
+        // Polygon
+        QPolygonF polygon;
+        QPaintEngine::PolygonDrawMode polygonMode = QPaintEngine::OddEvenMode;
+        // Rects
+        QVector<QRectF> rects;
+    };
+    void paintBand(QImage *target, uchar *bits, const QRect &band) const;
+    QScopedPointer<QPainterDisplayListEngine> m_engine;
+    QVector<Command> m_commands;
+    QThreadPool m_pool;
+    QSize m_size;
+    int m_depth = 32;
+    int m_dpiX = 96;
+    int m_dpiY = 96;
+};
+
+class QPainterDisplayListEngine : public QPaintEngine
+{
+public:
+    explicit QPainterDisplayListEngine(QPainterDisplayList *list);
+    virtual ~QPainterDisplayListEngine();
+
+    bool begin(QPaintDevice *device) override;
+    bool end() override;
+    Type type() const override;
+    void updateState(const QPaintEngineState &state) override;
+    void drawImage(const QRectF &rect, const QImage &image, const QRectF &sr, Qt::ImageConversionFlags flags) override;
+    void drawPixmap(const QRectF &rect, const QPixmap &pixmap, const QRectF &sr) override;
+    void drawTiledPixmap(const QRectF &rect, const QPixmap &pixmap, const QPointF &offset) override;
+    void drawPath(const QPainterPath &path) override;
+    void drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode) override;
+    void drawRects(const QRectF *rects, int rectCount) override;
+    // the other overloads of the base class end up in the ones above
+    using QPaintEngine::drawPolygon;
+    using QPaintEngine::drawRects;
+
+private:
+    static QBrush toImageBrush(const QBrush &brush);
+    QPainterDisplayList *m_list;
+    // the painter state as last recorded
+    QPainterDisplayList::Command m_state;
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "scene_scanout.h"
+
+#include <kwineffects.h>
+
+namespace KWin
+{
+
+bool effectsKeepWindowUnchanged(EffectWindow *w, const QRegion &region)
+{
+    ScreenPrePaintData screenData;
+    screenData.mask = Effect::PAINT_SCREEN_REGION;
+    screenData.paint = region;
+    effects->prePaintScreen(screenData, 0);
+    if (screenData.mask & (Effect::PAINT_SCREEN_TRANSFORMED | Effect::PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS)) {
+        return false;
+    }
+
+    WindowPrePaintData data;
+    data.mask = screenData.mask | Effect::PAINT_WINDOW_OPAQUE;
+    data.paint = region;
+    effects->prePaintWindow(w, data, 0);
+    if (!w->isPaintingEnabled()) {
+        return false;
+    }
+    return !(data.mask & (Effect::PAINT_WINDOW_TRANSFORMED | Effect::PAINT_WINDOW_TRANSLUCENT | Effect::PAINT_SCREEN_TRANSFORMED));
+}
+
+}
@@ -0,0 +1,46 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_SCENE_SCANOUT_H
+#define KWIN_SCENE_SCANOUT_H
+
+#include <QRegion>
+
+namespace KWin
+{
+
+class EffectWindow;
+
+/**
+ * Runs the pre paint passes of the active effects for the window @p w, which covers the
+ * @p region of a screen, and returns whether the effects leave the window as it is, so that
+ * its buffer can be shown on the screen without compositing.
+ *
+ * That is not the case as soon as an effect transforms the screen or the window, makes the
+ * window translucent or disables painting it. Effects which are active without changing the
+ * window, e.g. blur behind translucent windows, do not prevent the scanout.
+ *
+ * The passes are run with a time of @c 0 so that animations do not progress. The caller has to
+ * start the paint pass of the EffectsHandler and reset the disabled painting of the window.
+ **/
+bool effectsKeepWindowUnchanged(EffectWindow *w, const QRegion &region);
+
+}
+
+#endif
@@ -52,6 +52,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtDBus/QDBusPendingCall>
 #include <QWidget>
 
+#include <algorithm>
+
 namespace KWin {
 
 // Mouse should not move more than this many pixels
@@ -63,6 +65,8 @@ Edge::Edge(ScreenEdges *parent)
     , m_border(ElectricNone)
     , m_action(ElectricActionNone)
     , m_reserved(0)
+    , m_lastTrigger(-1)
+    , m_lastReset(-1)
     , m_approaching(false)
     , m_lastApproachingFactor(0)
     , m_blocked(false)
@@ -132,7 +136,7 @@ bool Edge::triggersFor(const QPoint &cursorPos) const
     return true;
 }
 
-bool Edge::check(const QPoint &cursorPos, const QDateTime &triggerTime, bool forceNoPushBack)
+bool Edge::check(const QPoint &cursorPos, qint64 triggerTime, bool forceNoPushBack)
 {
     if (!triggersFor(cursorPos)) {
         return false;
@@ -150,27 +154,27 @@ bool Edge::check(const QPoint &cursorPos, const QDateTime &triggerTime, bool for
     return false;
 }
 
-void Edge::markAsTriggered(const QPoint &cursorPos, const QDateTime &triggerTime)
+void Edge::markAsTriggered(const QPoint &cursorPos, qint64 triggerTime)
 {
     m_lastTrigger = triggerTime;
-    m_lastReset = QDateTime(); // invalidate
+    m_lastReset = -1; // invalidate
     m_triggeredPoint = cursorPos;
 }
 
-bool Edge::canActivate(const QPoint &cursorPos, const QDateTime &triggerTime)
+bool Edge::canActivate(const QPoint &cursorPos, qint64 triggerTime)
 {
     // we check whether either the timer has explicitly been invalidated (successfull trigger) or is
     // bigger than the reactivation threshold (activation "aborted", usually due to moving away the cursor
     // from the corner after successfull activation)
     // either condition means that "this is the first event in a new attempt"
-    if (!m_lastReset.isValid() || m_lastReset.msecsTo(triggerTime) > edges()->reActivationThreshold()) {
+    if (m_lastReset < 0 || triggerTime - m_lastReset > edges()->reActivationThreshold()) {
         m_lastReset = triggerTime;
         return false;
     }
-    if (m_lastTrigger.isValid() && m_lastTrigger.msecsTo(triggerTime) < edges()->reActivationThreshold()) {
+    if (m_lastTrigger >= 0 && triggerTime - m_lastTrigger < edges()->reActivationThreshold()) {
         return false;
     }
-    if (m_lastReset.msecsTo(triggerTime) < edges()->timeThreshold()) {
+    if (triggerTime - m_lastReset < edges()->timeThreshold()) {
         return false;
     }
     // does the check on position make any sense at all?
@@ -585,19 +589,17 @@ void WindowBasedEdge::doUpdateBlocking()
 AreaBasedEdge::AreaBasedEdge(ScreenEdges* parent)
     : Edge(parent)
 {
-    connect(input(), SIGNAL(globalPointerChanged(QPointF)), SLOT(pointerPosChanged(QPointF)));
 }
 
 AreaBasedEdge::~AreaBasedEdge()
 {
 }
 
-void AreaBasedEdge::pointerPosChanged(const QPointF &pos)
+void AreaBasedEdge::pointerPosChanged(const QPoint &p, qint64 now)
 {
     if (!isReserved()) {
         return;
     }
-    const QPoint p = pos.toPoint();
     if (approachGeometry().contains(p)) {
         if (!isApproaching()) {
             startApproaching();
@@ -612,7 +614,7 @@ void AreaBasedEdge::pointerPosChanged(const QPointF &pos)
     if (geometry().contains(p)) {
         // we don't push the cursor back as pointer warping is not supported on Wayland
         // TODO: this clearly needs improving
-        check(p, QDateTime(), true);
+        check(p, now, true);
     }
 }
 
@@ -628,6 +630,7 @@ ScreenEdges::ScreenEdges(QObject *parent)
     , m_timeThreshold(0)
     , m_reactivateThreshold(0)
     , m_virtualDesktopLayout(0)
+    , m_edgeIndexDirty(true)
     , m_actionTopLeft(ElectricActionNone)
     , m_actionTop(ElectricActionNone)
     , m_actionTopRight(ElectricActionNone)
@@ -639,6 +642,7 @@ ScreenEdges::ScreenEdges(QObject *parent)
 {
     QWidget w;
     m_cornerOffset = (w.physicalDpiX() + w.physicalDpiY() + 5) / 6;
+    m_clock.start();
 
     connect(workspace(), &Workspace::clientRemoved, [this](KWin::AbstractClient *c) {
         Client *client = qobject_cast<Client*>(c);
@@ -661,6 +665,9 @@ void ScreenEdges::init()
     reconfigure();
     updateLayout();
     recreateEdges();
+    if (kwinApp()->operationMode() != Application::OperationModeX11) {
+        connect(input(), &InputRedirection::globalPointerChanged, this, &ScreenEdges::handlePointerPosChanged, Qt::UniqueConnection);
+    }
 }
 static ElectricBorderAction electricBorderAction(const QString& name)
 {
@@ -875,6 +882,7 @@ void ScreenEdges::recreateEdges()
 {
     QList<Edge*> oldEdges(m_edges);
     m_edges.clear();
+    m_edgeIndexDirty = true;
     const QRect fullArea(0, 0, displayWidth(), displayHeight());
     QRegion processedRegion;
     for (int i=0; i<screens()->count(); ++i) {
@@ -1084,6 +1092,7 @@ void ScreenEdges::reserve(Client *client, ElectricBorder border)
             } else {
                 delete *it;
                 it = m_edges.erase(it);
+                m_edgeIndexDirty = true;
             }
         } else {
             it++;
@@ -1160,6 +1169,7 @@ void ScreenEdges::createEdgeForClient(Client *client, ElectricBorder border)
         Edge *edge = createEdge(border, x, y, width, height, false);
         edge->setClient(client);
         m_edges.append(edge);
+        m_edgeIndexDirty = true;
         if (client->isHiddenInternal()) {
             edge->reserve();
         }
@@ -1183,16 +1193,19 @@ void ScreenEdges::deleteEdgeForClient(Client* c)
         if ((*it)->client() == c) {
             delete *it;
             it = m_edges.erase(it);
+            m_edgeIndexDirty = true;
         } else {
             it++;
         }
     }
 }
 
-void ScreenEdges::check(const QPoint &pos, const QDateTime &now, bool forceNoPushBack)
+void ScreenEdges::check(const QPoint &pos, bool forceNoPushBack)
 {
+    const qint64 now = m_clock.elapsed();
     bool activatedForClient = false;
-    for (auto it = m_edges.begin(); it != m_edges.end(); ++it) {
+    const QVector<Edge*> edges = edgesAt(pos);
+    for (auto it = edges.constBegin(); it != edges.constEnd(); ++it) {
         if (!(*it)->isReserved()) {
             continue;
         }
@@ -1200,7 +1213,6 @@ void ScreenEdges::check(const QPoint &pos, const QDateTime &now, bool forceNoPus
             (*it)->startApproaching();
         }
         if ((*it)->client() != nullptr && activatedForClient) {
-            (*it)->markAsTriggered(pos, now);
             continue;
         }
         if ((*it)->check(pos, now, forceNoPushBack)) {
@@ -1209,13 +1221,89 @@ void ScreenEdges::check(const QPoint &pos, const QDateTime &now, bool forceNoPus
             }
         }
     }
+    if (activatedForClient) {
+        // don't let the edges of the other clients trigger right away
+        for (auto it = m_edges.constBegin(); it != m_edges.constEnd(); ++it) {
+            if ((*it)->client() && (*it)->isReserved()) {
+                (*it)->markAsTriggered(pos, now);
+            }
+        }
+    }
+}
+
+QVector<Edge*> ScreenEdges::edgesAt(const QPoint &pos)
+{
+    if (m_edgeIndexDirty) {
+        updateEdgeIndex();
+    }
+    QVector<Edge*> edges;
+    const QVector<int> column = m_edgesAtX.value(pos.x());
+    const QVector<int> row = m_edgesAtY.value(pos.y());
+    if (column.isEmpty() && row.isEmpty()) {
+        return edges;
+    }
+    QVector<int> indexes = column + row;
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    for (auto it = indexes.constBegin(); it != indexes.constEnd(); ++it) {
+        Edge *edge = m_edges.at(*it);
+        if (edge->geometry().contains(pos) || edge->approachGeometry().contains(pos)) {
+            edges << edge;
+        }
+    }
+    return edges;
+}
+
+void ScreenEdges::updateEdgeIndex()
+{
+    m_edgeIndexDirty = false;
+    m_edgesAtX.clear();
+    m_edgesAtY.clear();
+    for (int i = 0; i < m_edges.count(); ++i) {
+        const Edge *edge = m_edges.at(i);
+        QRect area = edge->geometry();
+        if (edge->approachGeometry().isValid()) {
+            area |= edge->approachGeometry();
+        }
+        // the edges are one pixel wide lines on the screen boundary, so each is added to the
+        // few columns or rows its approach area is deep
+        if (edge->isTop() || edge->isBottom()) {
+            if (!edge->isCorner()) {
+                for (int y = area.top(); y <= area.bottom(); ++y) {
+                    m_edgesAtY[y] << i;
+                }
+                continue;
+            }
+        }
+        for (int x = area.left(); x <= area.right(); ++x) {
+            m_edgesAtX[x] << i;
+        }
+    }
+}
+
+void ScreenEdges::handlePointerPosChanged(const QPointF &pos)
+{
+    const QPoint p = pos.toPoint();
+    const qint64 now = m_clock.elapsed();
+    const QVector<Edge*> edges = edgesAt(p);
+    // the edges the pointer moved out of still have to stop approaching
+    for (auto it = m_pointerEdges.constBegin(); it != m_pointerEdges.constEnd(); ++it) {
+        Edge *edge = it->data();
+        if (edge && !edges.contains(edge)) {
+            static_cast<AreaBasedEdge*>(edge)->pointerPosChanged(p, now);
+        }
+    }
+    m_pointerEdges.clear();
+    for (auto it = edges.constBegin(); it != edges.constEnd(); ++it) {
+        m_pointerEdges << QPointer<Edge>(*it);
+        static_cast<AreaBasedEdge*>(*it)->pointerPosChanged(p, now);
+    }
 }
 
 bool ScreenEdges::isEntered(xcb_enter_notify_event_t *event)
 {
     return handleEnterNotifiy(event->event,
-                              QPoint(event->root_x, event->root_y),
-                              QDateTime::fromMSecsSinceEpoch(event->time));
+                              QPoint(event->root_x, event->root_y));
 }
 
 bool ScreenEdges::isEntered(xcb_client_message_event_t *event)
@@ -1227,8 +1315,9 @@ bool ScreenEdges::isEntered(xcb_client_message_event_t *event)
                            QPoint(event->data.data32[2] >> 16, event->data.data32[2] & 0xffff));
 }
 
-bool ScreenEdges::handleEnterNotifiy(xcb_window_t window, const QPoint &point, const QDateTime &timestamp)
+bool ScreenEdges::handleEnterNotifiy(xcb_window_t window, const QPoint &point)
 {
+    const qint64 timestamp = m_clock.elapsed();
     bool activated = false;
     bool activatedForClient = false;
     for (auto it = m_edges.begin(); it != m_edges.end(); ++it) {
@@ -1272,8 +1361,7 @@ bool ScreenEdges::handleDndNotify(xcb_window_t window, const QPoint &point)
             continue;
         }
         if (edge->isReserved() && edge->window() == window) {
-            updateXTime();
-            edge->check(point, QDateTime::fromMSecsSinceEpoch(xTime()), true);
+            edge->check(point, m_clock.elapsed(), true);
             return true;
         }
     }
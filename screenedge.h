@@ -35,9 +35,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // KDE includes
 #include <KSharedConfig>
 // Qt
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QVector>
-#include <QDateTime>
 
 namespace KWin {
 
@@ -57,9 +59,10 @@ public:
     bool isCorner() const;
     bool isScreenEdge() const;
     bool triggersFor(const QPoint &cursorPos) const;
-    bool check(const QPoint &cursorPos, const QDateTime &triggerTime, bool forceNoPushBack = false);
-    void markAsTriggered(const QPoint &cursorPos, const QDateTime &triggerTime);
+    bool check(const QPoint &cursorPos, qint64 triggerTime, bool forceNoPushBack = false);
+    void markAsTriggered(const QPoint &cursorPos, qint64 triggerTime);
     bool isReserved() const;
+    const QRect &geometry() const;
     const QRect &approachGeometry() const;
 
     ElectricBorder border() const;
@@ -85,7 +88,6 @@ Q_SIGNALS:
 protected:
     ScreenEdges *edges();
     const ScreenEdges *edges() const;
-    const QRect &geometry() const;
     bool isBlocked() const;
     virtual void doGeometryUpdate();
     virtual void activate();
@@ -94,7 +96,7 @@ protected:
     virtual void doStopApproaching();
     virtual void doUpdateBlocking();
 private:
-    bool canActivate(const QPoint &cursorPos, const QDateTime &triggerTime);
+    bool canActivate(const QPoint &cursorPos, qint64 triggerTime);
     void handle(const QPoint &cursorPos);
     bool handleAction();
     bool handleByCallback();
@@ -106,8 +108,9 @@ private:
     int m_reserved;
     QRect m_geometry;
     QRect m_approachGeometry;
-    QDateTime m_lastTrigger;
-    QDateTime m_lastReset;
+    // in msec of ScreenEdges' monotonic clock, -1 if not set
+    qint64 m_lastTrigger;
+    qint64 m_lastReset;
     QPoint m_triggeredPoint;
     QHash<QObject *, QByteArray> m_callBacks;
     bool m_approaching;
@@ -153,8 +156,10 @@ public:
     explicit AreaBasedEdge(ScreenEdges *parent);
     virtual ~AreaBasedEdge();
 
-private Q_SLOTS:
-    void pointerPosChanged(const QPointF &pos);
+    /**
+     * Called by ScreenEdges for pointer motion inside this edge's area and for the motion leaving it.
+     **/
+    void pointerPosChanged(const QPoint &pos, qint64 now);
 };
 
 /**
@@ -230,10 +235,9 @@ public:
      * Check, if a screen edge is entered and trigger the appropriate action
      * if one is enabled for the current region and the timeout is satisfied
      * @param pos the position of the mouse pointer
-     * @param now the time when the function is called
      * @param forceNoPushBack needs to be called to workaround some DnD clients, don't use unless you want to chek on a DnD event
      */
-    void check(const QPoint& pos, const QDateTime &now, bool forceNoPushBack = false);
+    void check(const QPoint& pos, bool forceNoPushBack = false);
     /**
      * The (dpi dependent) length, reserved for the active corners of each edge - 1/3"
      */
@@ -361,11 +365,17 @@ private:
     Edge *createEdge(ElectricBorder border, int x, int y, int width, int height, bool createAction = true);
     void setActionForBorder(ElectricBorder border, ElectricBorderAction *oldValue, ElectricBorderAction newValue);
     ElectricBorderAction actionForEdge(Edge *edge) const;
-    bool handleEnterNotifiy(xcb_window_t window, const QPoint &point, const QDateTime &timestamp);
+    bool handleEnterNotifiy(xcb_window_t window, const QPoint &point);
     bool handleDndNotify(xcb_window_t window, const QPoint &point);
+    void handlePointerPosChanged(const QPointF &pos);
     void createEdgeForClient(Client *client, ElectricBorder border);
     void handleClientGeometryChanged();
     void deleteEdgeForClient(Client *client);
+    /**
+     * The edges whose geometry or approach geometry contains @p pos, in the order of m_edges.
+     **/
+    QVector<Edge*> edgesAt(const QPoint &pos);
+    void updateEdgeIndex();
     bool m_desktopSwitching;
     bool m_desktopSwitchingMovingClients;
     QSize m_cursorPushBackDistance;
@@ -373,6 +383,15 @@ private:
     int m_reactivateThreshold;
     Qt::Orientations m_virtualDesktopLayout;
     QList<Edge*> m_edges;
+    // the indexes into m_edges of the left, right and corner edges covering a column and of the
+    // top and bottom edges covering a row, rebuilt lazily once m_edges changed
+    QHash<int, QVector<int> > m_edgesAtX;
+    QHash<int, QVector<int> > m_edgesAtY;
+    bool m_edgeIndexDirty;
+    // the edges the pointer was in last, to stop their approaching once it moves away
+    QVector<QPointer<Edge> > m_pointerEdges;
+    // the clock for the trigger and reactivation thresholds
+    QElapsedTimer m_clock;
     KSharedConfig::Ptr m_config;
     ElectricBorderAction m_actionTopLeft;
     ElectricBorderAction m_actionTop;
@@ -0,0 +1,75 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "scriptcache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QtConcurrentMap>
+#include <QtScript/QScriptProgram>
+
+namespace KWin
+{
+
+namespace
+{
+struct Entry {
+    QDateTime lastModified;
+    qint64 size;
+    QScriptProgram program;
+};
+QMutex s_mutex;
+QHash<QString, Entry> s_entries;
+}
+
+QScriptProgram ScriptCache::program(const QString &fileName)
+{
+    const QFileInfo info(fileName);
+    const QDateTime lastModified = info.lastModified();
+    const qint64 size = info.size();
+    {
+        QMutexLocker locker(&s_mutex);
+        auto it = s_entries.constFind(fileName);
+        if (it != s_entries.constEnd() && it->lastModified == lastModified && it->size == size) {
+            return it->program;
+        }
+    }
+    // read without holding the lock, so that several files can be loaded at the same time
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QScriptProgram();
+    }
+    const QScriptProgram program(QString::fromUtf8(file.readAll()), fileName);
+    QMutexLocker locker(&s_mutex);
+    s_entries.insert(fileName, Entry{lastModified, size, program});
+    return program;
+}
+
+void ScriptCache::preload(const QStringList &fileNames)
+{
+    QStringList files = fileNames;
+    QtConcurrent::blockingMap(files, [] (const QString &fileName) {
+        program(fileName);
+    });
+}
+
+} // namespace KWin
@@ -0,0 +1,59 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_SCRIPTCACHE_H
+#define KWIN_SCRIPTCACHE_H
+
+#include <QStringList>
+
+class QScriptProgram;
+
+namespace KWin
+{
+
+/**
+ * @brief Process wide cache of the programs of scripted effects and KWin scripts.
+ *
+ * Loading a script used to read and decode its file each time the script got started, which
+ * happens for every scripted effect whenever compositing gets restarted. The ScriptCache keeps
+ * the QScriptProgram of each script file. An entry is reused as long as the modification time
+ * and the size of the file did not change, so a cache hit does not need to read the file.
+ *
+ * The cache is thread safe, so that the scripts can be loaded from worker threads ahead of
+ * being evaluated. Evaluating the programs has to happen on the thread of the QScriptEngine.
+ **/
+class ScriptCache
+{
+public:
+    /**
+     * @returns The program for the script at @p fileName, a null program if the file cannot be
+     * read.
+     **/
+    static QScriptProgram program(const QString &fileName);
+    /**
+     * Loads the programs of the script files @p fileNames in parallel and returns once all are
+     * loaded.
+     **/
+    static void preload(const QStringList &fileNames);
+};
+
+} // namespace KWin
+
+#endif // KWIN_SCRIPTCACHE_H
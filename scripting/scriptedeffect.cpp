@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scriptedeffect.h"
 #include "meta.h"
+#include "scriptcache.h"
 #include "scriptingutils.h"
 #include "workspace_wrapper.h"
 #include "../screenedge.h"
@@ -30,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include <QFile>
 #include <QtScript/QScriptEngine>
+#include <QtScript/QScriptProgram>
 #include <QtScript/QScriptValueIterator>
 #include <QtCore/QStandardPaths>
 
@@ -384,20 +386,29 @@ void fpx2FromScriptValue(const QScriptValue &value, KWin::FPx2 &fpx2)
     }
 }
 
-ScriptedEffect *ScriptedEffect::create(KService::Ptr effect)
+QString ScriptedEffect::locateScript(KService::Ptr effect)
 {
     const QString name = effect->property(QStringLiteral("X-KDE-PluginInfo-Name")).toString();
     const QString scriptName = effect->property(QStringLiteral("X-Plasma-MainScript")).toString();
     if (scriptName.isEmpty()) {
         qDebug() << "X-Plasma-MainScript not set";
-        return nullptr;
+        return QString();
     }
     const QString scriptFile = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
                                                       QStringLiteral(KWIN_NAME) + QStringLiteral("/effects/") + name + QStringLiteral("/contents/") + scriptName);
     if (scriptFile.isNull()) {
         qDebug() << "Could not locate the effect script";
+    }
+    return scriptFile;
+}
+
+ScriptedEffect *ScriptedEffect::create(KService::Ptr effect)
+{
+    const QString scriptFile = locateScript(effect);
+    if (scriptFile.isNull()) {
         return nullptr;
     }
+    const QString name = effect->property(QStringLiteral("X-KDE-PluginInfo-Name")).toString();
     return ScriptedEffect::create(name, scriptFile, effect->property(QStringLiteral("X-KDE-Ordering")).toInt());
 }
 
@@ -428,8 +439,8 @@ ScriptedEffect::~ScriptedEffect()
 
 bool ScriptedEffect::init(const QString &effectName, const QString &pathToScript)
 {
-    QFile scriptFile(pathToScript);
-    if (!scriptFile.open(QIODevice::ReadOnly)) {
+    const QScriptProgram program = ScriptCache::program(pathToScript);
+    if (program.isNull()) {
         qDebug() << "Could not open script file: " << pathToScript;
         return false;
     }
@@ -488,13 +499,12 @@ bool ScriptedEffect::init(const QString &effectName, const QString &pathToScript
     cancelFunc.setData(m_engine->newQObject(this));
     m_engine->globalObject().setProperty(QStringLiteral("cancel"), cancelFunc);
 
-    QScriptValue ret = m_engine->evaluate(QString::fromUtf8(scriptFile.readAll()));
+    QScriptValue ret = m_engine->evaluate(program);
 
     if (ret.isError()) {
         signalHandlerException(ret);
         return false;
     }
-    scriptFile.close();
     return true;
 }
 
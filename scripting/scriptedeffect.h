@@ -66,6 +66,10 @@ public:
     QString activeConfig() const;
     void setActiveConfig(const QString &name);
     static ScriptedEffect *create(KService::Ptr effect);
+    /**
+     * @returns The path to the main script of the scripted @p effect, a null string if not found.
+     **/
+    static QString locateScript(KService::Ptr effect);
     static ScriptedEffect *create(const QString &effectName, const QString &pathToScript, int chainPosition);
     virtual ~ScriptedEffect();
     /**
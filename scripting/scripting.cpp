@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // own
 #include "dbuscall.h"
 #include "meta.h"
+#include "scriptcache.h"
 #include "scriptingutils.h"
 #include "workspace_wrapper.h"
 #include "screenedgeitem.h"
@@ -47,6 +48,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QtScript/QScriptEngine>
+#include <QtScript/QScriptProgram>
 #include <QtScript/QScriptValue>
 #include <QtCore/QStandardPaths>
 #include <QQuickWindow>
@@ -446,24 +448,19 @@ void KWin::Script::run()
         return;
     }
     m_starting = true;
-    QFutureWatcher<QByteArray> *watcher = new QFutureWatcher<QByteArray>(this);
+    QFutureWatcher<QScriptProgram> *watcher = new QFutureWatcher<QScriptProgram>(this);
     connect(watcher, SIGNAL(finished()), SLOT(slotScriptLoadedFromFile()));
     watcher->setFuture(QtConcurrent::run(this, &KWin::Script::loadScriptFromFile));
 }
 
-QByteArray KWin::Script::loadScriptFromFile()
+QScriptProgram KWin::Script::loadScriptFromFile()
 {
-    if (!scriptFile().open(QIODevice::ReadOnly)) {
-        return QByteArray();
-    }
-    QByteArray result(scriptFile().readAll());
-    scriptFile().close();
-    return result;
+    return ScriptCache::program(scriptFile().fileName());
 }
 
 void KWin::Script::slotScriptLoadedFromFile()
 {
-    QFutureWatcher<QByteArray> *watcher = dynamic_cast< QFutureWatcher< QByteArray>* >(sender());
+    QFutureWatcher<QScriptProgram> *watcher = dynamic_cast< QFutureWatcher<QScriptProgram>* >(sender());
     if (!watcher) {
         // not invoked from a QFutureWatcher
         return;
@@ -482,7 +479,7 @@ void KWin::Script::slotScriptLoadedFromFile()
     KWin::MetaScripting::supplyConfig(m_engine);
     installScriptFunctions(m_engine);
 
-    QScriptValue ret = m_engine->evaluate(QString::fromUtf8(watcher->result()));
+    QScriptValue ret = m_engine->evaluate(watcher->result());
 
     if (ret.isError()) {
         sigException(ret);
@@ -628,30 +625,7 @@ void KWin::Scripting::init()
 
 void KWin::Scripting::start()
 {
-#if 0
-    // TODO make this threaded again once KConfigGroup is sufficiently thread safe, bug #305361 and friends
-    // perform querying for the services in a thread
-    QFutureWatcher<LoadScriptList> *watcher = new QFutureWatcher<LoadScriptList>(this);
-    connect(watcher, SIGNAL(finished()), this, SLOT(slotScriptsQueried()));
-    watcher->setFuture(QtConcurrent::run(this, &KWin::Scripting::queryScriptsToLoad, pluginStates, offers));
-#else
-    LoadScriptList scriptsToLoad = queryScriptsToLoad();
-    for (LoadScriptList::const_iterator it = scriptsToLoad.constBegin();
-            it != scriptsToLoad.constEnd();
-            ++it) {
-        if (it->first) {
-            loadScript(it->second.first, it->second.second);
-        } else {
-            loadDeclarativeScript(it->second.first, it->second.second);
-        }
-    }
-
-    runScripts();
-#endif
-}
-
-LoadScriptList KWin::Scripting::queryScriptsToLoad()
-{
+    // KConfig is not thread safe, bug #305361 and friends, so the plugin states are read here
     KSharedConfig::Ptr _config = KSharedConfig::openConfig();
     static bool s_started = false;
     if (s_started) {
@@ -659,10 +633,20 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
     } else {
         s_started = true;
     }
-    QMap<QString,QString> pluginStates = KConfigGroup(_config, "Plugins").entryMap();
+    const QMap<QString,QString> pluginStates = KConfigGroup(_config, "Plugins").entryMap();
+
+    // perform querying for the services in a thread
+    QFutureWatcher<LoadScriptList> *watcher = new QFutureWatcher<LoadScriptList>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(slotScriptsQueried()));
+    watcher->setFuture(QtConcurrent::run(this, &KWin::Scripting::queryScriptsToLoad, pluginStates));
+}
+
+LoadScriptList KWin::Scripting::queryScriptsToLoad(const QMap<QString, QString> &pluginStates)
+{
     KService::List offers = KServiceTypeTrader::self()->query(QStringLiteral("KWin/Script"));
 
     LoadScriptList scriptsToLoad;
+    QStringList scripts;
 
     foreach (const KService::Ptr & service, offers) {
         KPluginInfo plugininfo(service);
@@ -689,7 +673,12 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
             continue;
         }
         scriptsToLoad << qMakePair(javaScript, qMakePair(file, pluginName));
+        if (javaScript) {
+            scripts << file;
+        }
     }
+    // read the scripts while still in the thread, running them hits the cache
+    ScriptCache::preload(scripts);
     return scriptsToLoad;
 }
 
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QFile>
 #include <QHash>
+#include <QMap>
 #include <QStringList>
 #include <QtScript/QScriptEngineAgent>
 
@@ -39,6 +40,7 @@ class QGraphicsScene;
 class QMenu;
 class QMutex;
 class QScriptEngine;
+class QScriptProgram;
 class QScriptValue;
 class QQuickWindow;
 class KConfigGroup;
@@ -244,10 +246,10 @@ private Q_SLOTS:
 private:
     void installScriptFunctions(QScriptEngine *engine);
     /**
-     * Read the script from file into a byte array.
-     * If file cannot be read an empty byte array is returned.
+     * Loads the script from file through the ScriptCache.
+     * If file cannot be read a null program is returned.
      **/
-    QByteArray loadScriptFromFile();
+    QScriptProgram loadScriptFromFile();
     QScriptEngine *m_engine;
     bool m_starting;
     QScopedPointer<ScriptUnloaderAgent> m_agent;
@@ -370,7 +372,7 @@ private Q_SLOTS:
 
 private:
     void init();
-    LoadScriptList queryScriptsToLoad();
+    LoadScriptList queryScriptsToLoad(const QMap<QString, QString> &pluginStates);
     static Scripting *s_self;
     QQmlEngine *m_qmlEngine;
     WorkspaceWrapper *m_workspaceWrapper;
@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "screens.h"
 #include "workspace.h"
 
+#include <algorithm>
+
 namespace KWin {
 namespace ScriptingClientModel {
 
@@ -180,58 +182,109 @@ void ClientLevel::addClient(Client *client)
     if (containsClient(client)) {
         return;
     }
-    emit beginInsert(m_clients.count(), m_clients.count(), id());
-    m_clients.insert(nextId(), client);
+    if (m_pendingClients.isEmpty()) {
+        QMetaObject::invokeMethod(this, "addPendingClients", Qt::QueuedConnection);
+    }
+    m_pendingClients << client;
+}
+
+void ClientLevel::addPendingClients()
+{
+    if (m_pendingClients.isEmpty()) {
+        return;
+    }
+    const int first = m_ids.count();
+    emit beginInsert(first, first + m_pendingClients.count() - 1, id());
+    for (Client *client : m_pendingClients) {
+        const quint32 clientId = nextId();
+        m_ids << clientId;
+        m_clients.insert(clientId, client);
+        m_clientIds.insert(client, clientId);
+    }
+    m_pendingClients.clear();
     emit endInsert();
 }
 
 void ClientLevel::removeClient(Client *client)
 {
-    int index = 0;
-    QMap<quint32, Client*>::iterator it = m_clients.begin();
-    for (; it != m_clients.end(); ++it, ++index) {
-        if (it.value() == client) {
-            break;
-        }
+    if (m_pendingClients.removeOne(client)) {
+        return;
     }
-    if (it == m_clients.end()) {
+    const int row = rowForId(m_clientIds.value(client));
+    if (row == -1) {
         return;
     }
-    emit beginRemove(index, index, id());
-    m_clients.erase(it);
-    emit endRemove();
+    removeRows(QVector<int>() << row);
+}
+
+void ClientLevel::removeRows(const QVector<int> &rows)
+{
+    // rows are sorted, remove contiguous ranges starting at the end so that the preceding rows
+    // do not change
+    int end = rows.count() - 1;
+    while (end >= 0) {
+        int start = end;
+        while (start > 0 && rows.at(start - 1) == rows.at(start) - 1) {
+            --start;
+        }
+        const int firstRow = rows.at(start);
+        const int lastRow = rows.at(end);
+        emit beginRemove(firstRow, lastRow, id());
+        for (int row = firstRow; row <= lastRow; ++row) {
+            m_clientIds.remove(m_clients.take(m_ids.at(row)));
+        }
+        m_ids.remove(firstRow, lastRow - firstRow + 1);
+        emit endRemove();
+        end = start - 1;
+    }
 }
 
 void ClientLevel::init()
 {
     const ClientList &clients = Workspace::self()->clientList();
+    m_ids.reserve(clients.count());
     for (ClientList::const_iterator it = clients.begin(); it != clients.end(); ++it) {
         Client *client = *it;
         setupClientConnections(client);
         if (!exclude(client) && shouldAdd(client)) {
-            m_clients.insert(nextId(), client);
+            const quint32 clientId = nextId();
+            m_ids << clientId;
+            m_clients.insert(clientId, client);
+            m_clientIds.insert(client, clientId);
         }
     }
 }
 
 void ClientLevel::reInit()
 {
+    // collect the changes to remove the excluded Clients in ranges and add the others at once
+    QVector<int> rows;
     const ClientList &clients = Workspace::self()->clientList();
     for (ClientList::const_iterator it = clients.begin(); it != clients.end(); ++it) {
-        checkClient((*it));
+        Client *client = *it;
+        const bool shouldInclude = !exclude(client) && shouldAdd(client);
+        if (shouldInclude) {
+            addClient(client);
+        } else if (m_pendingClients.removeOne(client)) {
+            continue;
+        } else {
+            const int row = rowForId(m_clientIds.value(client));
+            if (row != -1) {
+                rows << row;
+            }
+        }
     }
+    std::sort(rows.begin(), rows.end());
+    removeRows(rows);
+    addPendingClients();
 }
 
 quint32 ClientLevel::idForRow(int row) const
 {
-    if (row >= m_clients.size()) {
+    if (row < 0 || row >= m_ids.count()) {
         return 0;
     }
-    QMap<quint32, Client*>::const_iterator it = m_clients.constBegin();
-    for (int i=0; i<row; ++i) {
-        ++it;
-    }
-    return it.key();
+    return m_ids.at(row);
 }
 
 bool ClientLevel::containsId(quint32 id) const
@@ -241,36 +294,21 @@ bool ClientLevel::containsId(quint32 id) const
 
 int ClientLevel::rowForId(quint32 id) const
 {
-    int row = 0;
-    for (QMap<quint32, Client*>::const_iterator it = m_clients.constBegin();
-            it != m_clients.constEnd();
-            ++it, ++row) {
-        if (it.key() == id) {
-            return row;
-        }
+    auto it = std::lower_bound(m_ids.constBegin(), m_ids.constEnd(), id);
+    if (it == m_ids.constEnd() || *it != id) {
+        return -1;
     }
-    return -1;
+    return it - m_ids.constBegin();
 }
 
 Client *ClientLevel::clientForId(quint32 child) const
 {
-    QMap<quint32, Client*>::const_iterator it = m_clients.constFind(child);
-    if (it == m_clients.constEnd()) {
-        return nullptr;
-    }
-    return it.value();
+    return m_clients.value(child);
 }
 
 bool ClientLevel::containsClient(Client *client) const
 {
-    for (QMap<quint32, Client*>::const_iterator it = m_clients.constBegin();
-            it != m_clients.constEnd();
-            ++it) {
-        if (it.value() == client) {
-            return true;
-        }
-    }
-    return false;
+    return m_clientIds.contains(client) || m_pendingClients.contains(client);
 }
 
 const AbstractLevel *ClientLevel::levelForId(quint32 id) const
@@ -22,7 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
+#include <QHash>
 #include <QList>
+#include <QVector>
 
 namespace KWin {
 class AbstractClient;
@@ -210,6 +212,10 @@ private:
  *
  * The Clients in this group are not sorted in any particular way. It's a simple list which only
  * gets added to. If some sorting should be applied, use a QSortFilterProxyModel.
+ *
+ * As ids are handed out in increasing order the rows are kept as a sorted vector of ids, which
+ * allows to map between rows and ids without walking the list. Clients which get added within
+ * one event cycle, e.g. during session restore, are inserted as one range of rows.
  */
 class ClientLevel : public AbstractLevel
 {
@@ -234,15 +240,22 @@ private Q_SLOTS:
     // uses sender()
     void checkClient();
     void reInit();
+    void addPendingClients();
 private:
     void checkClient(KWin::Client *client);
     void setupClientConnections(Client *client);
     void addClient(Client *client);
     void removeClient(Client *client);
+    void removeRows(const QVector<int> &rows);
     bool shouldAdd(Client *client) const;
     bool exclude(Client *client) const;
     bool containsClient(Client *client) const;
-    QMap<quint32, Client*> m_clients;
+    // ids of the rows, sorted
+    QVector<quint32> m_ids;
+    QHash<quint32, Client*> m_clients;
+    QHash<Client*, quint32> m_clientIds;
+    // Clients to be added at the end of the event cycle
+    QList<Client*> m_pendingClients;
 };
 
 class SimpleClientModel : public ClientModel
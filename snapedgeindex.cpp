@@ -0,0 +1,144 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "snapedgeindex.h"
+#include "client.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+SnapEdgeIndex::SnapEdgeIndex()
+    : m_serial(0)
+{
+}
+
+SnapEdgeIndex::~SnapEdgeIndex() = default;
+
+void SnapEdgeIndex::add(Client *c)
+{
+    if (m_entries.contains(c)) {
+        update(c);
+        return;
+    }
+    Entry entry;
+    entry.geometry = c->geometry();
+    entry.desktop = c->desktop();
+    entry.serial = m_serial++;
+    m_entries.insert(c, entry);
+    insertEdges(c, entry);
+}
+
+void SnapEdgeIndex::remove(Client *c)
+{
+    auto it = m_entries.find(c);
+    if (it == m_entries.end()) {
+        return;
+    }
+    removeEdges(c, it.value());
+    m_entries.erase(it);
+}
+
+void SnapEdgeIndex::update(Client *c)
+{
+    auto it = m_entries.find(c);
+    if (it == m_entries.end()) {
+        return;
+    }
+    Entry &entry = it.value();
+    if (entry.geometry == c->geometry() && entry.desktop == c->desktop()) {
+        return;
+    }
+    removeEdges(c, entry);
+    entry.geometry = c->geometry();
+    entry.desktop = c->desktop();
+    insertEdges(c, entry);
+}
+
+void SnapEdgeIndex::insertEdges(Client *c, const Entry &entry)
+{
+    Edges &edges = m_desktops[entry.desktop];
+    const QRect &g = entry.geometry;
+    edges.vertical.insert(g.x(), c);
+    edges.vertical.insert(g.x() + g.width(), c);
+    edges.horizontal.insert(g.y(), c);
+    edges.horizontal.insert(g.y() + g.height(), c);
+}
+
+void SnapEdgeIndex::removeEdges(Client *c, const Entry &entry)
+{
+    auto it = m_desktops.find(entry.desktop);
+    if (it == m_desktops.end()) {
+        return;
+    }
+    Edges &edges = it.value();
+    const QRect &g = entry.geometry;
+    edges.vertical.remove(g.x(), c);
+    edges.vertical.remove(g.x() + g.width(), c);
+    edges.horizontal.remove(g.y(), c);
+    edges.horizontal.remove(g.y() + g.height(), c);
+    if (edges.vertical.isEmpty() && edges.horizontal.isEmpty()) {
+        m_desktops.erase(it);
+    }
+}
+
+void SnapEdgeIndex::collect(const QMultiMap<int, Client*> &edges, int position, int range, QSet<Client*> &found)
+{
+    for (auto it = edges.lowerBound(position - range);
+            it != edges.constEnd() && it.key() <= position + range;
+            ++it) {
+        found.insert(it.value());
+    }
+}
+
+ClientList SnapEdgeIndex::candidates(int desktop, const QRect &geometry, int range) const
+{
+    const int left = geometry.x();
+    const int right = geometry.x() + geometry.width();
+    const int top = geometry.y();
+    const int bottom = geometry.y() + geometry.height();
+
+    QSet<Client*> found;
+    for (auto it = m_desktops.constBegin(); it != m_desktops.constEnd(); ++it) {
+        if (desktop != NET::OnAllDesktops && it.key() != desktop && it.key() != NET::OnAllDesktops) {
+            continue;
+        }
+        const Edges &edges = it.value();
+        collect(edges.vertical, left, range, found);
+        collect(edges.vertical, right, range, found);
+        collect(edges.horizontal, top, range, found);
+        collect(edges.horizontal, bottom, range, found);
+    }
+
+    ClientList result;
+    result.reserve(found.size());
+    for (Client *c : found) {
+        result << c;
+    }
+    // keep the order of the workspace's client list, the snapping code depends on it for ties
+    std::sort(result.begin(), result.end(),
+        [this](Client *a, Client *b) {
+            return m_entries.value(a).serial < m_entries.value(b).serial;
+        }
+    );
+    return result;
+}
+
+} // namespace
@@ -0,0 +1,94 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_SNAP_EDGE_INDEX_H
+#define KWIN_SNAP_EDGE_INDEX_H
+// KWin
+#include "utils.h"
+// Qt
+#include <QHash>
+#include <QMultiMap>
+#include <QRect>
+#include <QSet>
+
+namespace KWin
+{
+
+class Client;
+
+/**
+ * @brief Index of the window edges used for window snapping.
+ *
+ * Workspace::adjustClientPosition and Workspace::adjustClientSize are called for each motion
+ * event of an interactive move resize. Instead of testing all Clients the SnapEdgeIndex keeps
+ * the vertical (left/right) and horizontal (top/bottom) edges of each Client sorted per virtual
+ * desktop, so that the Clients which can possibly snap are found by a range query.
+ *
+ * The index only narrows down the set of Clients; all snap conditions are still evaluated by
+ * the caller. The candidates are returned in the order the Clients got added to the index, which
+ * matches the order of Workspace's client list.
+ **/
+class SnapEdgeIndex
+{
+public:
+    SnapEdgeIndex();
+    ~SnapEdgeIndex();
+
+    /**
+     * Adds @p c to the index using its current geometry and virtual desktop.
+     **/
+    void add(Client *c);
+    /**
+     * Removes @p c from the index. Does nothing if @p c is not indexed.
+     **/
+    void remove(Client *c);
+    /**
+     * Re-indexes @p c after its geometry or virtual desktop changed.
+     * Does nothing if @p c is not indexed.
+     **/
+    void update(Client *c);
+    /**
+     * @returns The Clients on @p desktop (including those on all desktops) with at least one edge
+     * closer than @p range to the corresponding edge of @p geometry. If @p desktop is
+     * NET::OnAllDesktops Clients on any desktop are considered.
+     **/
+    ClientList candidates(int desktop, const QRect &geometry, int range) const;
+
+private:
+    struct Entry {
+        QRect geometry;
+        int desktop;
+        quint64 serial;
+    };
+    struct Edges {
+        QMultiMap<int, Client*> vertical;
+        QMultiMap<int, Client*> horizontal;
+    };
+    void insertEdges(Client *c, const Entry &entry);
+    void removeEdges(Client *c, const Entry &entry);
+    static void collect(const QMultiMap<int, Client*> &edges, int position, int range, QSet<Client*> &found);
+
+    QHash<Client*, Entry> m_entries;
+    QHash<int, Edges> m_desktops;
+    quint64 m_serial;
+};
+
+} // namespace
+
+#endif // KWIN_SNAP_EDGE_INDEX_H
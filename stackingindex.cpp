@@ -0,0 +1,252 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "stackingindex.h"
+#include <toplevel.h>
+#include "virtualdesktops.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+StackingIndex::StackingIndex() = default;
+
+StackingIndex::~StackingIndex() = default;
+
+const ToplevelList &StackingIndex::onDesktop(const ToplevelList &stacking, uint desktop)
+{
+    sync(stacking);
+    if (desktop < 1 || desktop > uint(m_desktops.count())) {
+        static const ToplevelList s_empty;
+        return s_empty;
+    }
+    return m_desktops.at(desktop - 1);
+}
+
+const ToplevelList &StackingIndex::onActivity(const ToplevelList &stacking, const QString &activity)
+{
+    sync(stacking);
+    auto it = m_activities.find(activity);
+    if (it == m_activities.end()) {
+        ToplevelList list;
+        for (auto t = m_stacking.constBegin(); t != m_stacking.constEnd(); ++t) {
+            if ((*t)->isOnActivity(activity)) {
+                list << *t;
+            }
+        }
+        it = m_activities.insert(activity, list);
+    }
+    return it.value();
+}
+
+void StackingIndex::updateDesktop(Toplevel *t)
+{
+    // windows not indexed yet get added with the next stacking order
+    if (!m_entries.contains(t)) {
+        return;
+    }
+    removeFromDesktops(t);
+    insertIntoDesktops(t);
+}
+
+void StackingIndex::updateActivities(Toplevel *t)
+{
+    if (!m_entries.contains(t)) {
+        return;
+    }
+    removeFromActivities(t);
+    insertIntoActivities(t);
+}
+
+void StackingIndex::sync(const ToplevelList &stacking)
+{
+    if (m_desktops.count() != int(VirtualDesktopManager::self()->count())) {
+        rebuild(stacking);
+        return;
+    }
+    if (stacking.isSharedWith(m_stacking)) {
+        return;
+    }
+    if (!applyChange(stacking)) {
+        rebuild(stacking);
+        return;
+    }
+    m_stacking = stacking;
+}
+
+void StackingIndex::rebuild(const ToplevelList &stacking)
+{
+    m_stacking = stacking;
+    m_entries.clear();
+    m_entries.reserve(stacking.count());
+    m_activities.clear();
+    m_desktops.clear();
+    m_desktops.resize(VirtualDesktopManager::self()->count());
+    // appending in stacking order keeps the lists sorted
+    for (int i = 0; i < stacking.count(); ++i) {
+        Toplevel *t = stacking.at(i);
+        Entry &entry = m_entries[t];
+        entry.position = i;
+        entry.desktop = t->isOnAllDesktops() ? -1 : t->desktop();
+        if (entry.desktop == -1) {
+            for (int d = 0; d < m_desktops.count(); ++d) {
+                m_desktops[d] << t;
+            }
+        } else if (entry.desktop >= 1 && entry.desktop <= m_desktops.count()) {
+            m_desktops[entry.desktop - 1] << t;
+        }
+    }
+}
+
+bool StackingIndex::applyChange(const ToplevelList &stacking)
+{
+    const ToplevelList &old = m_stacking;
+    // the range [first, oldLast] of the old order got replaced by [first, newLast]
+    const int common = qMin(old.count(), stacking.count());
+    int first = 0;
+    while (first < common && old.at(first) == stacking.at(first)) {
+        ++first;
+    }
+    int oldLast = old.count() - 1;
+    int newLast = stacking.count() - 1;
+    while (oldLast >= first && newLast >= first && old.at(oldLast) == stacking.at(newLast)) {
+        --oldLast;
+        --newLast;
+    }
+    if (oldLast < first && newLast < first) {
+        // same order in a new list
+        return true;
+    }
+    if (oldLast < first && newLast == first) {
+        // one window added
+        updatePositions(stacking, first, stacking.count() - 1);
+        insert(stacking.at(first));
+        return true;
+    }
+    if (newLast < first && oldLast == first) {
+        // one window removed
+        remove(old.at(first));
+        updatePositions(stacking, first, stacking.count() - 1);
+        return true;
+    }
+    if (oldLast == first && newLast == first) {
+        // one window replaced, e.g. a closed Client by its Deleted
+        remove(old.at(first));
+        updatePositions(stacking, first, first);
+        insert(stacking.at(first));
+        return true;
+    }
+    if (oldLast != newLast) {
+        return false;
+    }
+    // one window raised or lowered within the range
+    Toplevel *moved = nullptr;
+    if (old.at(first) == stacking.at(newLast)
+            && std::equal(old.constBegin() + first + 1, old.constBegin() + oldLast + 1, stacking.constBegin() + first)) {
+        moved = old.at(first);
+    } else if (old.at(oldLast) == stacking.at(first)
+            && std::equal(old.constBegin() + first, old.constBegin() + oldLast, stacking.constBegin() + first + 1)) {
+        moved = old.at(oldLast);
+    }
+    if (!moved) {
+        return false;
+    }
+    remove(moved);
+    updatePositions(stacking, first, newLast);
+    insert(moved);
+    return true;
+}
+
+void StackingIndex::updatePositions(const ToplevelList &stacking, int from, int to)
+{
+    for (int i = from; i <= to; ++i) {
+        m_entries[stacking.at(i)].position = i;
+    }
+}
+
+void StackingIndex::insert(Toplevel *t)
+{
+    insertIntoDesktops(t);
+    insertIntoActivities(t);
+}
+
+void StackingIndex::remove(Toplevel *t)
+{
+    if (!m_entries.contains(t)) {
+        return;
+    }
+    removeFromDesktops(t);
+    removeFromActivities(t);
+    m_entries.remove(t);
+}
+
+void StackingIndex::insertIntoDesktops(Toplevel *t)
+{
+    Entry &entry = m_entries[t];
+    entry.desktop = t->isOnAllDesktops() ? -1 : t->desktop();
+    if (entry.desktop == -1) {
+        for (int d = 0; d < m_desktops.count(); ++d) {
+            insertSorted(m_desktops[d], t);
+        }
+    } else if (entry.desktop >= 1 && entry.desktop <= m_desktops.count()) {
+        insertSorted(m_desktops[entry.desktop - 1], t);
+    }
+}
+
+void StackingIndex::removeFromDesktops(Toplevel *t)
+{
+    const int desktop = m_entries.value(t).desktop;
+    if (desktop == -1) {
+        for (int d = 0; d < m_desktops.count(); ++d) {
+            m_desktops[d].removeOne(t);
+        }
+    } else if (desktop >= 1 && desktop <= m_desktops.count()) {
+        m_desktops[desktop - 1].removeOne(t);
+    }
+}
+
+void StackingIndex::insertIntoActivities(Toplevel *t)
+{
+    for (auto it = m_activities.begin(); it != m_activities.end(); ++it) {
+        if (t->isOnActivity(it.key())) {
+            insertSorted(it.value(), t);
+        }
+    }
+}
+
+void StackingIndex::removeFromActivities(Toplevel *t)
+{
+    for (auto it = m_activities.begin(); it != m_activities.end(); ++it) {
+        it.value().removeOne(t);
+    }
+}
+
+void StackingIndex::insertSorted(ToplevelList &list, Toplevel *t) const
+{
+    const int position = m_entries.value(t).position;
+    auto it = std::lower_bound(list.begin(), list.end(), position,
+        [this](Toplevel *other, int value) {
+            return m_entries.value(other).position < value;
+        }
+    );
+    list.insert(it, t);
+}
+
+} // namespace
@@ -0,0 +1,100 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_STACKING_INDEX_H
+#define KWIN_STACKING_INDEX_H
+// KWin
+#include "utils.h"
+// Qt
+#include <QHash>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief Per virtual desktop and per activity views of Workspace's stacking order.
+ *
+ * Finding the top most window on a desktop, the desktop window or the windows to hide and show
+ * on a desktop switch used to walk the complete stacking order filtering with isOnDesktop. The
+ * StackingIndex keeps for each virtual desktop the windows on it, including the ones on all
+ * desktops, in stacking order. The lists for activities are created on first use.
+ *
+ * The index is kept up to date incrementally. Workspace calls updateDesktop and
+ * updateActivities when a window changes its desktop or activities, which moves just that
+ * window between the lists. A new stacking order is compared with the indexed one on the next
+ * query: a single window being raised, lowered, added, removed or replaced is moved in,
+ * inserted into or removed from the lists it is on. Only other changes of the stacking order
+ * and a change of the number of virtual desktops rebuild the index.
+ **/
+class StackingIndex
+{
+public:
+    StackingIndex();
+    ~StackingIndex();
+
+    /**
+     * @returns The windows of @p stacking on @p desktop, bottom most first. An empty list if
+     * @p desktop is not a valid virtual desktop.
+     **/
+    const ToplevelList &onDesktop(const ToplevelList &stacking, uint desktop);
+    /**
+     * @returns The windows of @p stacking on @p activity, bottom most first.
+     **/
+    const ToplevelList &onActivity(const ToplevelList &stacking, const QString &activity);
+    /**
+     * Moves @p t to the lists of the virtual desktops it is on now.
+     **/
+    void updateDesktop(Toplevel *t);
+    /**
+     * Moves @p t to the lists of the activities it is on now.
+     **/
+    void updateActivities(Toplevel *t);
+
+private:
+    struct Entry {
+        // index in the stacking order
+        int position = 0;
+        // the desktop the window is indexed on, -1 for all desktops
+        int desktop = 0;
+    };
+    void sync(const ToplevelList &stacking);
+    void rebuild(const ToplevelList &stacking);
+    bool applyChange(const ToplevelList &stacking);
+    void updatePositions(const ToplevelList &stacking, int from, int to);
+    void insert(Toplevel *t);
+    void remove(Toplevel *t);
+    void insertIntoDesktops(Toplevel *t);
+    void removeFromDesktops(Toplevel *t);
+    void insertIntoActivities(Toplevel *t);
+    void removeFromActivities(Toplevel *t);
+    void insertSorted(ToplevelList &list, Toplevel *t) const;
+
+    // a copy of the stacking order the index is built from, shares the data with Workspace's
+    // list until that one gets changed
+    ToplevelList m_stacking;
+    QHash<Toplevel*, Entry> m_entries;
+    // indexed by desktop - 1
+    QVector<ToplevelList> m_desktops;
+    QHash<QString, ToplevelList> m_activities;
+};
+
+} // namespace
+
+#endif // KWIN_STACKING_INDEX_H
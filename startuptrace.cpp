@@ -0,0 +1,86 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "startuptrace.h"
+#include "utils.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+namespace KWin
+{
+
+namespace
+{
+struct Phase {
+    QString name;
+    qint64 start;
+    qint64 end;
+};
+}
+
+static QMutex s_mutex;
+static QElapsedTimer s_clock;
+static QVector<Phase> s_phases;
+
+void StartupTrace::begin(const QString &phase)
+{
+    QMutexLocker locker(&s_mutex);
+    if (!s_clock.isValid()) {
+        s_clock.start();
+    }
+    for (auto it = s_phases.constBegin(); it != s_phases.constEnd(); ++it) {
+        if (it->name == phase) {
+            return;
+        }
+    }
+    s_phases << Phase{phase, s_clock.elapsed(), -1};
+}
+
+void StartupTrace::end(const QString &phase)
+{
+    QMutexLocker locker(&s_mutex);
+    for (auto it = s_phases.begin(); it != s_phases.end(); ++it) {
+        if (it->name == phase) {
+            if (it->end < 0) {
+                it->end = s_clock.elapsed();
+                qCDebug(KWIN_CORE) << "Startup phase" << phase << "took" << it->end - it->start << "ms";
+            }
+            return;
+        }
+    }
+}
+
+QString StartupTrace::supportInformation()
+{
+    QMutexLocker locker(&s_mutex);
+    QString support;
+    for (auto it = s_phases.constBegin(); it != s_phases.constEnd(); ++it) {
+        if (it->end < 0) {
+            support.append(QStringLiteral("%1: started at %2 ms, not finished\n").arg(it->name).arg(it->start));
+        } else {
+            support.append(QStringLiteral("%1: started at %2 ms, took %3 ms\n").arg(it->name).arg(it->start).arg(it->end - it->start));
+        }
+    }
+    return support;
+}
+
+} // namespace
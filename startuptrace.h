@@ -0,0 +1,70 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2015 KWin Team <kwin@kde.org>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_STARTUP_TRACE_H
+#define KWIN_STARTUP_TRACE_H
+
+#include <kwin_export.h>
+
+#include <QString>
+
+namespace KWin
+{
+
+/**
+ * @brief Records how long the named phases of KWin's startup take.
+ *
+ * A phase is started with begin and finished with end, which may happen in a later event cycle
+ * or, for work done in a thread, in a different thread. The Scope helper covers a block. Only
+ * the first run of each phase is recorded, so restarting e.g. the Compositor later on does not
+ * add to the trace.
+ *
+ * The times are relative to the first recorded phase. The trace is part of the support
+ * information and each finished phase is logged as debug output.
+ **/
+class KWIN_EXPORT StartupTrace
+{
+public:
+    static void begin(const QString &phase);
+    static void end(const QString &phase);
+    /**
+     * @returns The recorded phases with start time and duration for the support information.
+     **/
+    static QString supportInformation();
+
+    class Scope
+    {
+    public:
+        explicit Scope(const QString &phase)
+            : m_phase(phase)
+        {
+            begin(m_phase);
+        }
+        ~Scope()
+        {
+            end(m_phase);
+        }
+    private:
+        QString m_phase;
+    };
+};
+
+} // namespace
+
+#endif // KWIN_STARTUP_TRACE_H
@@ -47,12 +47,17 @@ void MockTabBoxHandler::setActiveClient(const QWeakPointer< TabBox::TabBoxClient
     m_activeClient = client;
 }
 
-QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::clientToAddToList(TabBox::TabBoxClient *client, int desktop) const
+QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::clientToAddToList(TabBox::TabBoxClient *client, int desktop, const QSet<TabBox::TabBoxClient*> &added) const
 {
     Q_UNUSED(desktop)
     QList< QSharedPointer< TabBox::TabBoxClient > >::const_iterator it = m_windows.constBegin();
     for (; it != m_windows.constEnd(); ++it) {
         if ((*it).data() == client) {
+            // like the real implementation the modal dialog replaces its parent, but only once
+            const QWeakPointer< TabBox::TabBoxClient > modal = m_modals.value(client);
+            if (!modal.isNull()) {
+                return added.contains(modal.data()) ? QWeakPointer< TabBox::TabBoxClient >() : modal;
+            }
             return QWeakPointer< TabBox::TabBoxClient >(*it);
         }
     }
@@ -108,6 +113,18 @@ QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::createMockWindow(const Q
     return QWeakPointer< TabBox::TabBoxClient >(client);
 }
 
+QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::createMockModal(const QString &caption, WId id)
+{
+    QSharedPointer< TabBox::TabBoxClient > client(new MockTabBoxClient(caption, id));
+    m_modalWindows.append(client);
+    return QWeakPointer< TabBox::TabBoxClient >(client);
+}
+
+void MockTabBoxHandler::setModal(TabBox::TabBoxClient *client, const QWeakPointer< TabBox::TabBoxClient > &modal)
+{
+    m_modals.insert(client, modal);
+}
+
 void MockTabBoxHandler::closeWindow(TabBox::TabBoxClient *client)
 {
     QList< QSharedPointer< TabBox::TabBoxClient > >::iterator it = m_windows.begin();
@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_MOCK_TABBOX_HANDLER_H
 
 #include "../tabboxhandler.h"
+
+#include <QHash>
+
 namespace KWin
 {
 class MockTabBoxHandler : public TabBox::TabBoxHandler
@@ -36,7 +39,7 @@ public:
     virtual int activeScreen() const {
         return 0;
     }
-    virtual QWeakPointer< TabBox::TabBoxClient > clientToAddToList(TabBox::TabBoxClient *client, int desktop) const;
+    virtual QWeakPointer< TabBox::TabBoxClient > clientToAddToList(TabBox::TabBoxClient *client, int desktop, const QSet<TabBox::TabBoxClient*> &added) const;
     virtual int currentDesktop() const {
         return 1;
     }
@@ -96,8 +99,15 @@ public:
     // mock methods
     QWeakPointer<TabBox::TabBoxClient> createMockWindow(const QString &caption, WId id);
     void closeWindow(TabBox::TabBoxClient *client);
+    /**
+     * Creates a modal dialog which is not in the focus chain, use setModal to assign it.
+     **/
+    QWeakPointer<TabBox::TabBoxClient> createMockModal(const QString &caption, WId id);
+    void setModal(TabBox::TabBoxClient *client, const QWeakPointer<TabBox::TabBoxClient> &modal);
 private:
     QList< QSharedPointer<TabBox::TabBoxClient> > m_windows;
+    QList< QSharedPointer<TabBox::TabBoxClient> > m_modalWindows;
+    QHash<TabBox::TabBoxClient*, QWeakPointer<TabBox::TabBoxClient> > m_modals;
     QWeakPointer<TabBox::TabBoxClient> m_activeClient;
 };
 } // namespace KWin
@@ -89,4 +89,72 @@ void TestTabBoxClientModel::testCreateClientListActiveClientNotInFocusChain()
     QCOMPARE(clientModel->rowCount(), 1);
 }
 
+void TestTabBoxClientModel::testCreateClientListIncremental()
+{
+    MockTabBoxHandler tabboxhandler;
+    tabboxhandler.setConfig(TabBox::TabBoxConfig());
+    TabBox::ClientModel *clientModel = new TabBox::ClientModel(&tabboxhandler);
+    QSignalSpy resetSpy(clientModel, SIGNAL(modelReset()));
+    QVERIFY(resetSpy.isValid());
+    QSignalSpy insertedSpy(clientModel, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QVERIFY(insertedSpy.isValid());
+    QSignalSpy removedSpy(clientModel, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QVERIFY(removedSpy.isValid());
+
+    tabboxhandler.createMockWindow(QString("test"), 1);
+    QWeakPointer<TabBox::TabBoxClient> client = tabboxhandler.createMockWindow(QString("test2"), 2);
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QCOMPARE(insertedSpy.count(), 1);
+
+    // recreating without changes does not touch the rows
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // a new window gets inserted
+    tabboxhandler.createMockWindow(QString("test3"), 3);
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 3);
+    QCOMPARE(insertedSpy.count(), 2);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // a closed window gets removed
+    QSharedPointer<TabBox::TabBoxClient> clientOwner = client.toStrongRef();
+    tabboxhandler.closeWindow(client.data());
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QCOMPARE(insertedSpy.count(), 2);
+    QCOMPARE(removedSpy.count(), 1);
+    QVERIFY(!clientModel->index(client).isValid());
+
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+void TestTabBoxClientModel::testCreateClientListSharedModal()
+{
+    MockTabBoxHandler tabboxhandler;
+    tabboxhandler.setConfig(TabBox::TabBoxConfig());
+    TabBox::ClientModel *clientModel = new TabBox::ClientModel(&tabboxhandler);
+    QWeakPointer<TabBox::TabBoxClient> parent1 = tabboxhandler.createMockWindow(QString("parent1"), 1);
+    QWeakPointer<TabBox::TabBoxClient> parent2 = tabboxhandler.createMockWindow(QString("parent2"), 2);
+    QWeakPointer<TabBox::TabBoxClient> client = tabboxhandler.createMockWindow(QString("test"), 3);
+    QWeakPointer<TabBox::TabBoxClient> modal = tabboxhandler.createMockModal(QString("modal"), 4);
+    tabboxhandler.setModal(parent1.data(), modal);
+    tabboxhandler.setModal(parent2.data(), modal);
+
+    // the modal replaces both parents, but is only added once
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QVERIFY(clientModel->index(client).isValid());
+    QVERIFY(clientModel->index(modal).isValid());
+
+    // the modal being in the previous list does not drop it
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QVERIFY(clientModel->index(client).isValid());
+    QVERIFY(clientModel->index(modal).isValid());
+}
+
 QTEST_MAIN(TestTabBoxClientModel)
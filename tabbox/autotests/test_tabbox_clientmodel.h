@@ -48,6 +48,16 @@ private slots:
      * See BUG: 306260
      **/
     void testCreateClientListActiveClientNotInFocusChain();
+    /**
+     * Tests that recreating the Client list updates the model row by row
+     * instead of resetting it.
+     **/
+    void testCreateClientListIncremental();
+    /**
+     * Tests that a modal dialog shared by two Clients is added once, also when
+     * it is already in the previous Client list.
+     **/
+    void testCreateClientListSharedModal();
 };
 
 #endif
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "tabboxhandler.h"
 // Qt
 #include <QIcon>
+#include <QSet>
 // TODO: remove with Qt 5, only for HTML escaping the caption
 #include <QTextDocument>
 #include <QTextStream>
@@ -169,8 +170,11 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         }
     }
 
-    m_clientList.clear();
-    QList< QWeakPointer< TabBoxClient > > stickyClients;
+    TabBoxClientList clientList;
+    TabBoxClientList stickyClients;
+    QWeakPointer<TabBoxClient> startClient;
+    // the Clients already added to the new list, modal dialogs are checked against these
+    QSet<TabBoxClient*> added;
 
     switch(tabBox->config().clientSwitchingMode()) {
     case TabBoxConfig::FocusChainSwitching: {
@@ -183,11 +187,13 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         }
         TabBoxClient* stop = c;
         do {
-            QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop);
+            QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop, added);
             if (!add.isNull()) {
-                m_clientList += add;
+                added.insert(add.data());
                 if (add.data()->isFirstInTabBox()) {
                     stickyClients << add;
+                } else {
+                    clientList += add;
                 }
             }
             c = tabBox->nextClientFocusChain(c).data();
@@ -201,15 +207,15 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         TabBoxClient* stop = c;
         int index = 0;
         while (c) {
-            QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop);
+            QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop, added);
             if (!add.isNull()) {
-                if (start == add.data()) {
-                    m_clientList.removeAll(add);
-                    m_clientList.prepend(add);
-                } else
-                    m_clientList += add;
+                added.insert(add.data());
                 if (add.data()->isFirstInTabBox()) {
                     stickyClients << add;
+                } else if (start == add.data()) {
+                    startClient = add;
+                } else {
+                    clientList += add;
                 }
             }
             if (index >= stacking.size() - 1) {
@@ -224,16 +230,91 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         break;
     }
     }
-    foreach (const QWeakPointer< TabBoxClient > &c, stickyClients) {
-        m_clientList.removeAll(c);
-        m_clientList.prepend(c);
+    // sticky clients go first, the last found one at the top, followed by the start client
+    TabBoxClientList list;
+    list.reserve(stickyClients.count() + clientList.count() + 2);
+    for (int i = stickyClients.count() - 1; i >= 0; --i) {
+        list << stickyClients.at(i);
     }
-    if (tabBox->config().showDesktopMode() == TabBoxConfig::ShowDesktopClient || m_clientList.isEmpty()) {
+    if (!startClient.isNull()) {
+        list << startClient;
+    }
+    list << clientList;
+    if (tabBox->config().showDesktopMode() == TabBoxConfig::ShowDesktopClient || list.isEmpty()) {
         QWeakPointer<TabBoxClient> desktopClient = tabBox->desktopClient();
         if (!desktopClient.isNull())
-            m_clientList.append(desktopClient);
+            list.append(desktopClient);
+    }
+    setClientList(list);
+}
+
+void ClientModel::setClientList(const TabBoxClientList &list)
+{
+    // Instead of resetting the model the changes are applied row by row, so that views can keep
+    // the delegates of Clients which stay in the list.
+    if (m_clientList.isEmpty()) {
+        if (!list.isEmpty()) {
+            beginInsertRows(QModelIndex(), 0, list.count() - 1);
+            m_clientList = list;
+            endInsertRows();
+        }
+        return;
+    }
+    QSet<TabBoxClient*> clients;
+    clients.reserve(list.count());
+    for (const QWeakPointer<TabBoxClient> &client : list) {
+        clients.insert(client.data());
+    }
+    // remove the Clients not in the new list, this includes the closed ones
+    auto isRemoved = [this, &clients] (int row) {
+        TabBoxClient *client = m_clientList.at(row).data();
+        return !client || !clients.contains(client);
+    };
+    for (int last = m_clientList.count() - 1; last >= 0; --last) {
+        if (!isRemoved(last)) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && isRemoved(first - 1)) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_clientList.erase(m_clientList.begin() + first, m_clientList.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+    // move the remaining Clients into place and insert the new ones
+    for (int row = 0; row < list.count(); ++row) {
+        const QWeakPointer<TabBoxClient> &client = list.at(row);
+        if (row < m_clientList.count() && m_clientList.at(row) == client) {
+            continue;
+        }
+        int from = -1;
+        for (int i = row + 1; i < m_clientList.count(); ++i) {
+            if (m_clientList.at(i) == client) {
+                from = i;
+                break;
+            }
+        }
+        if (from != -1) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_clientList.move(from, row);
+            endMoveRows();
+        } else {
+            beginInsertRows(QModelIndex(), row, row);
+            m_clientList.insert(row, client);
+            endInsertRows();
+        }
+    }
+    if (m_clientList.count() > list.count()) {
+        beginRemoveRows(QModelIndex(), list.count(), m_clientList.count() - 1);
+        m_clientList.erase(m_clientList.begin() + list.count(), m_clientList.end());
+        endRemoveRows();
+    }
+    // the kept Clients might have changed while the TabBox was not shown
+    if (!m_clientList.isEmpty()) {
+        emit dataChanged(index(0, 0), index(m_clientList.count() - 1, 0));
     }
-    reset();
 }
 
 void ClientModel::close(int i)
@@ -75,7 +75,7 @@ public:
 
     /**
     * Generates a new list of TabBoxClients based on the current config.
-    * Calling this method will reset the model. If partialReset is true
+    * The model gets updated row by row to the new list. If partialReset is true
     * the top of the list is kept as a starting point. If not the the
     * current active client is used as the starting point to generate the
     * list.
@@ -104,6 +104,7 @@ public Q_SLOTS:
     void activate(int index);
 
 private:
+    void setClientList(const TabBoxClientList &list);
     TabBoxClientList m_clientList;
 };
 
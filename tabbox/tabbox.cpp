@@ -245,7 +245,7 @@ bool TabBoxHandlerImpl::checkMultiScreen(TabBoxClient* client) const
     }
 }
 
-QWeakPointer<TabBoxClient> TabBoxHandlerImpl::clientToAddToList(TabBoxClient* client, int desktop) const
+QWeakPointer<TabBoxClient> TabBoxHandlerImpl::clientToAddToList(TabBoxClient* client, int desktop, const QSet<TabBoxClient*> &added) const
 {
     if (!client) {
         return QWeakPointer<TabBoxClient>();
@@ -264,7 +264,7 @@ QWeakPointer<TabBoxClient> TabBoxHandlerImpl::clientToAddToList(TabBoxClient* cl
         AbstractClient* modal = current->findModal();
         if (modal == nullptr || modal == current)
             ret = current;
-        else if (!clientList().contains(modal->tabBoxClient()))
+        else if (!added.contains(modal->tabBoxClient().data()))
             ret = modal;
         else {
             // nothing
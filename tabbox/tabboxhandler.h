@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QModelIndex>
 #include <QPixmap>
+#include <QSet>
 #include <QString>
 #include <X11/Xlib.h>
 #include <fixx11h.h>
@@ -204,10 +205,10 @@ public:
     * </UL>
     * @param client The client to be checked for inclusion
     * @param desktop The desktop the client should be on. This is irrelevant if allDesktops is set
-    * @param allDesktops Add clients from all desktops or only from current
+    * @param added The clients already added to the list which is being built
     * @return The client to be included in the list or NULL if it isn't to be included
     */
-    virtual QWeakPointer<TabBoxClient> clientToAddToList(TabBoxClient* client, int desktop) const = 0;
+    virtual QWeakPointer<TabBoxClient> clientToAddToList(TabBoxClient* client, int desktop, const QSet<TabBoxClient*> &added) const = 0;
     /**
     * @return The first desktop window in the stacking order.
     */
@@ -23,12 +23,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "client.h"
 #include "composite.h"
 #include "effects.h"
+#include "options.h"
 #include "workspace.h"
 #include "composite.h"
 // Qt
 #include <QDebug>
 #include <QPainter>
 #include <QQuickWindow>
+#include <QTimer>
 
 namespace KWin
 {
@@ -39,7 +41,10 @@ AbstractThumbnailItem::AbstractThumbnailItem(QQuickItem *parent)
     , m_brightness(1.0)
     , m_saturation(1.0)
     , m_clipToItem()
+    , m_updateTimer(new QTimer(this))
 {
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, &QTimer::timeout, this, &AbstractThumbnailItem::performUpdate);
     Q_ASSERT(Compositor::isCreated());
     connect(Compositor::self(), SIGNAL(compositingToggled(bool)), SLOT(compositingToggled()));
     compositingToggled();
@@ -94,6 +99,32 @@ void AbstractThumbnailItem::effectWindowAdded()
     }
 }
 
+void AbstractThumbnailItem::scheduleUpdate()
+{
+    if (m_updateTimer->isActive()) {
+        // already scheduled
+        return;
+    }
+    const uint maxFps = options->thumbnailMaxFps();
+    if (maxFps == 0 || !m_lastUpdate.isValid()) {
+        performUpdate();
+        return;
+    }
+    const qint64 interval = 1000 / maxFps;
+    const qint64 elapsed = m_lastUpdate.elapsed();
+    if (elapsed >= interval) {
+        performUpdate();
+    } else {
+        m_updateTimer->start(interval - elapsed);
+    }
+}
+
+void AbstractThumbnailItem::performUpdate()
+{
+    m_lastUpdate.start();
+    update();
+}
+
 void AbstractThumbnailItem::setBrightness(qreal brightness)
 {
     if (qFuzzyCompare(brightness, m_brightness)) {
@@ -178,7 +209,7 @@ void WindowThumbnailItem::paint(QPainter *painter)
 void WindowThumbnailItem::repaint(KWin::EffectWindow *w)
 {
     if (static_cast<KWin::EffectWindowImpl*>(w)->window()->window() == m_wId) {
-        update();
+        scheduleUpdate();
     }
 }
 
@@ -215,7 +246,7 @@ void DesktopThumbnailItem::paint(QPainter *painter)
 void DesktopThumbnailItem::repaint(EffectWindow *w)
 {
     if (w->isOnDesktop(m_desktop)) {
-        update();
+        scheduleUpdate();
     }
 }
 
@@ -21,10 +21,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef KWIN_THUMBNAILITEM_H
 #define KWIN_THUMBNAILITEM_H
 
+#include <QElapsedTimer>
 #include <QPointer>
 #include <QWeakPointer>
 #include <QQuickPaintedItem>
 
+class QTimer;
+
 namespace KWin
 {
 
@@ -56,6 +59,12 @@ Q_SIGNALS:
 
 protected:
     explicit AbstractThumbnailItem(QQuickItem *parent = 0);
+    /**
+     * Updates the item for damage of the thumbnailed windows. The updates are limited to
+     * Options::thumbnailMaxFps, further damage within that interval is merged into one
+     * delayed update.
+     **/
+    void scheduleUpdate();
 
 protected Q_SLOTS:
     virtual void repaint(KWin::EffectWindow* w) = 0;
@@ -64,6 +73,7 @@ private Q_SLOTS:
     void init();
     void effectWindowAdded();
     void compositingToggled();
+    void performUpdate();
 
 private:
     void findParentEffectWindow();
@@ -71,6 +81,8 @@ private:
     qreal m_brightness;
     qreal m_saturation;
     QPointer<QQuickItem> m_clipToItem;
+    QTimer *m_updateTimer;
+    QElapsedTimer m_lastUpdate;
 };
 
 class WindowThumbnailItem : public AbstractThumbnailItem
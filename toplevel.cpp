@@ -107,6 +107,23 @@ void Toplevel::detectShape(Window id)
     }
 }
 
+Xcb::ShapeExtents Toplevel::fetchShape(xcb_window_t id) const
+{
+    if (!Xcb::Extensions::self()->isShapeAvailable()) {
+        return Xcb::ShapeExtents();
+    }
+    return Xcb::ShapeExtents(id);
+}
+
+void Toplevel::readShape(Xcb::ShapeExtents &extents)
+{
+    const bool wasShape = is_shape;
+    is_shape = !extents.isNull() && extents->bounding_shaped > 0;
+    if (wasShape != is_shape) {
+        emit shapedChanged();
+    }
+}
+
 // used only by Deleted::copy()
 void Toplevel::copyToDeleted(Toplevel* c)
 {
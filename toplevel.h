@@ -429,6 +429,13 @@ protected:
     virtual ~Toplevel();
     void setWindowHandles(xcb_window_t client);
     void detectShape(Window id);
+    /**
+     * Issues the request for the shape extents of window @p id without waiting for the reply.
+     * Returns an empty wrapper if the shape extension is not available.
+     * @see readShape
+     **/
+    Xcb::ShapeExtents fetchShape(xcb_window_t id) const;
+    void readShape(Xcb::ShapeExtents &extents);
     virtual void propertyNotifyEvent(xcb_property_notify_event_t *e);
     virtual void damageNotifyEvent();
     virtual void clientMessageEvent(xcb_client_message_event_t *e);
@@ -39,12 +39,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "input.h"
 #include "logind.h"
 #include "killwindow.h"
+#include "layeredstackingorder.h"
 #include "netinfo.h"
 #include "outline.h"
 #include "placement.h"
 #include "rules.h"
 #include "screenedge.h"
 #include "screens.h"
+#include "snapedgeindex.h"
+#include "stackingindex.h"
+#include "startuptrace.h"
 #include "scripting/scripting.h"
 #ifdef KWIN_BUILD_TABBOX
 #include "tabbox.h"
@@ -65,6 +69,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KLocalizedString>
 #include <KStartupInfo>
 // Qt
+#include <QElapsedTimer>
 #include <QtConcurrentRun>
 
 namespace KWin
@@ -125,9 +130,14 @@ Workspace::Workspace(bool restore)
     , startup(0)
     , set_active_client_recursion(0)
     , block_stacking_updates(0)
+    , m_snapEdgeIndex(new SnapEdgeIndex)
+    , m_stackingIndex(new StackingIndex)
+    , m_layeredStackingOrder(new LayeredStackingOrder)
 {
     // If KWin was already running it saved its configuration after loosing the selection -> Reread
     QFuture<void> reparseConfigFuture = QtConcurrent::run(options, &Options::reparseConfiguration);
+    // the window rules are in their own config file, they can be read at the same time
+    QFuture<QList<Rules*> > rulesFuture = QtConcurrent::run(&RuleBook::readRules);
 
     _self = this;
 
@@ -151,6 +161,8 @@ Workspace::Workspace(bool restore)
 
     options->loadConfig();
     options->loadCompositingConfig(false);
+    // load the decoration plugin while the remaining parts of the Workspace get created
+    QFuture<void> decorationFuture = Decoration::DecorationBridge::preloadPlugin();
     ColorMapper *colormaps = new ColorMapper(this);
     connect(this, &Workspace::clientActivated, colormaps, &ColorMapper::update);
 
@@ -159,7 +171,7 @@ Workspace::Workspace(bool restore)
     if (restore)
         loadSessionInfo();
 
-    RuleBook::create(this)->load();
+    RuleBook::create(this)->setRules(rulesFuture.result());
 
     // Call this before XSelectInput() on the root window
     startup = new KStartupInfo(
@@ -191,6 +203,7 @@ Workspace::Workspace(bool restore)
     }
     connect(this, &Workspace::currentDesktopChanged, m_compositor, &Compositor::addRepaintFull);
 
+    decorationFuture.waitForFinished();
     auto decorationBridge = Decoration::DecorationBridge::create(this);
     decorationBridge->init();
     connect(this, &Workspace::configChanged, decorationBridge, &Decoration::DecorationBridge::reconfigure);
@@ -297,6 +310,7 @@ void Workspace::init()
 
     {
         // Begin updates blocker block
+        StartupTrace::Scope trace(QStringLiteral("Managing existing windows"));
         StackingUpdatesBlocker blocker(this);
 
         Xcb::Tree tree(rootWindow());
@@ -327,10 +341,12 @@ void Workspace::init()
             } else if (attr->map_state != XCB_MAP_STATE_UNMAPPED) {
                 if (Application::wasCrash()) {
                     fixPositionAfterCrash(wins[i], windowGeometries.at(i).data());
+                    // the window got moved, the batched geometry is outdated
+                    windowGeometries[i] = Xcb::WindowGeometry(wins[i]);
                 }
 
-                // ### This will request the attributes again
-                createClient(wins[i], true);
+                // reuses the already requested attributes and geometry
+                createClient(wins[i], true, attr, windowGeometries[i]);
             }
         }
 
@@ -378,6 +394,7 @@ void Workspace::init()
     if (auto w = waylandServer()) {
         connect(w, &WaylandServer::shellClientAdded, this,
             [this] (ShellClient *c) {
+                trackStackingIndex(c);
                 if (!unconstrained_stacking_order.contains(c))
                     unconstrained_stacking_order.append(c);   // Raise if it hasn't got any stacking position yet
                 if (!stacking_order.contains(c))    // It'll be updated later, and updateToolWindows() requires
@@ -457,6 +474,22 @@ Workspace::~Workspace()
 
 Client* Workspace::createClient(xcb_window_t w, bool is_mapped)
 {
+    return createClient(w, [is_mapped, w](Client *c) {
+        return c->manage(w, is_mapped);
+    });
+}
+
+Client* Workspace::createClient(xcb_window_t w, bool is_mapped, Xcb::WindowAttributes &attr, Xcb::WindowGeometry &geometry)
+{
+    return createClient(w, [is_mapped, w, &attr, &geometry](Client *c) {
+        return c->manage(w, is_mapped, attr, geometry);
+    });
+}
+
+Client* Workspace::createClient(xcb_window_t w, std::function<bool (Client*)> manage)
+{
+    QElapsedTimer manageTimer;
+    manageTimer.start();
     StackingUpdatesBlocker blocker(this);
     Client* c = new Client();
     connect(c, SIGNAL(needsRepaint()), m_compositor, SLOT(scheduleRepaint()));
@@ -467,11 +500,17 @@ Client* Workspace::createClient(xcb_window_t w, bool is_mapped)
     connect(c, SIGNAL(blockingCompositingChanged(KWin::Client*)), m_compositor, SLOT(updateCompositeBlocking(KWin::Client*)));
     connect(c, SIGNAL(clientFullScreenSet(KWin::Client*,bool,bool)), ScreenEdges::self(), SIGNAL(checkBlocking()));
     connect(c, &Client::desktopPresenceChanged, this, &Workspace::desktopPresenceChanged, Qt::QueuedConnection);
-    if (!c->manage(w, is_mapped)) {
+    if (!manage(c)) {
         Client::deleteClient(c);
         return NULL;
     }
     addClient(c);
+
+    const qint64 elapsed = manageTimer.nsecsElapsed();
+    m_manageStatistics.count++;
+    m_manageStatistics.total += elapsed;
+    m_manageStatistics.maximum = qMax(m_manageStatistics.maximum, elapsed);
+    qCDebug(KWIN_CORE) << "Managed window" << w << "in" << elapsed / 1000 << "usec";
     return c;
 }
 
@@ -490,11 +529,18 @@ Unmanaged* Workspace::createUnmanaged(xcb_window_t w)
     return c;
 }
 
+void Workspace::trackStackingIndex(AbstractClient *c)
+{
+    connect(c, &AbstractClient::desktopChanged, this, [this, c] { m_stackingIndex->updateDesktop(c); });
+    connect(c, &AbstractClient::activitiesChanged, this, [this, c] { m_stackingIndex->updateActivities(c); });
+}
+
 void Workspace::addClient(Client* c)
 {
     Group* grp = findGroup(c->window());
 
     emit clientAdded(c);
+    trackStackingIndex(c);
 
     if (grp != NULL)
         grp->gotLeader(c);
@@ -506,6 +552,9 @@ void Workspace::addClient(Client* c)
     } else {
         FocusChain::self()->update(c, FocusChain::Update);
         clients.append(c);
+        m_snapEdgeIndex->add(c);
+        connect(c, &Client::geometryChanged, this, [this, c] { m_snapEdgeIndex->update(c); });
+        connect(c, &Client::desktopChanged, this, [this, c] { m_snapEdgeIndex->update(c); });
     }
     if (!unconstrained_stacking_order.contains(c))
         unconstrained_stacking_order.append(c);   // Raise if it hasn't got any stacking position yet
@@ -570,6 +619,7 @@ void Workspace::removeClient(Client* c)
     // TODO: if marked client is removed, notify the marked list
     clients.removeAll(c);
     desktops.removeAll(c);
+    m_snapEdgeIndex->remove(c);
     x_stacking_dirty = true;
     attention_chain.removeAll(c);
     Group* group = findGroup(c->window());
@@ -870,20 +920,29 @@ void Workspace::slotCurrentDesktopChanged(uint oldDesktop, uint newDesktop)
 
 void Workspace::updateClientVisibilityOnDesktopChange(uint oldDesktop, uint newDesktop)
 {
-    ObscuringWindows obs_wins;
-    for (ToplevelList::ConstIterator it = stacking_order.constBegin();
-            it != stacking_order.constEnd();
+    // Only the Clients on exactly one of the two desktops change their visibility, the ones on
+    // both or on neither of them keep their state. They are collected first to hide and show
+    // them in one go, the X requests are flushed once at the end.
+    ClientList hide;
+    const ToplevelList &onOldDesktop = stackingOrderOnDesktop(oldDesktop);
+    for (ToplevelList::ConstIterator it = onOldDesktop.constBegin();
+            it != onOldDesktop.constEnd();
             ++it) {
         Client *c = qobject_cast<Client*>(*it);
-        if (!c) {
+        if (!c || c == movingClient || !c->isOnCurrentActivity()) {
             continue;
         }
-        if (!c->isOnDesktop(newDesktop) && c != movingClient && c->isOnCurrentActivity()) {
-            if (c->isShown(true) && c->isOnDesktop(oldDesktop) && !compositing())
-                obs_wins.create(c);
-            (c)->updateVisibility();
+        if (!c->isOnDesktop(newDesktop)) {
+            hide << c;
         }
     }
+    ObscuringWindows obs_wins;
+    for (ClientList::ConstIterator it = hide.constBegin(); it != hide.constEnd(); ++it) {
+        Client *c = *it;
+        if (c->isShown(true) && !compositing())
+            obs_wins.create(c);
+        c->updateVisibility();
+    }
     // Now propagate the change, after hiding, before showing
     rootInfo()->setCurrentDesktop(VirtualDesktopManager::self()->current());
 
@@ -891,14 +950,17 @@ void Workspace::updateClientVisibilityOnDesktopChange(uint oldDesktop, uint newD
         movingClient->setDesktop(newDesktop);
     }
 
-    for (int i = stacking_order.size() - 1; i >= 0 ; --i) {
-        Client *c = qobject_cast<Client*>(stacking_order.at(i));
-        if (!c) {
+    // a copy, updating the visibility must not change the list being iterated
+    const ToplevelList onNewDesktop = stackingOrderOnDesktop(newDesktop);
+    for (int i = onNewDesktop.size() - 1; i >= 0 ; --i) {
+        Client *c = qobject_cast<Client*>(onNewDesktop.at(i));
+        if (!c || !c->isOnCurrentActivity()) {
             continue;
         }
-        if (c->isOnDesktop(newDesktop) && c->isOnCurrentActivity())
+        if (!c->isOnDesktop(oldDesktop) || c == movingClient)
             c->updateVisibility();
     }
+    xcb_flush(connection());
     if (showingDesktop())   // Do this only after desktop change to avoid flicker
         setShowingDesktop(false);
 }
@@ -939,8 +1001,9 @@ AbstractClient *Workspace::findClientToActivateOnDesktop(uint desktop)
     }
     // from actiavtion.cpp
     if (options->isNextFocusPrefersMouse()) {
-        ToplevelList::const_iterator it = stackingOrder().constEnd();
-        while (it != stackingOrder().constBegin()) {
+        const ToplevelList &list = stackingOrderOnDesktop(desktop);
+        ToplevelList::const_iterator it = list.constEnd();
+        while (it != list.constBegin()) {
             Client *client = qobject_cast<Client*>(*(--it));
             if (!client) {
                 continue;
@@ -983,14 +1046,16 @@ void Workspace::updateCurrentActivity(const QString &new_activity)
 
     const QString &old_activity = Activities::self()->previous();
 
-    for (ToplevelList::ConstIterator it = stacking_order.constBegin();
-            it != stacking_order.constEnd();
+    // copies, the visibility updates may change the stacking order
+    const ToplevelList onCurrentDesktop = stackingOrderOnDesktop(VirtualDesktopManager::self()->current());
+    for (ToplevelList::ConstIterator it = onCurrentDesktop.constBegin();
+            it != onCurrentDesktop.constEnd();
             ++it) {
         Client *c = qobject_cast<Client*>(*it);
         if (!c) {
             continue;
         }
-        if (!c->isOnActivity(new_activity) && c != movingClient && c->isOnCurrentDesktop()) {
+        if (!c->isOnActivity(new_activity) && c != movingClient) {
             if (c->isShown(true) && c->isOnActivity(old_activity) && !compositing())
                 obs_wins.create(c);
             c->updateVisibility();
@@ -1006,13 +1071,13 @@ void Workspace::updateCurrentActivity(const QString &new_activity)
         movingClient->setDesktop( new_desktop );
         */
 
-    for (int i = stacking_order.size() - 1; i >= 0 ; --i) {
-        Client *c = qobject_cast<Client*>(stacking_order.at(i));
+    const ToplevelList onNewActivity = stackingOrderOnActivity(new_activity);
+    for (int i = onNewActivity.size() - 1; i >= 0 ; --i) {
+        Client *c = qobject_cast<Client*>(onNewActivity.at(i));
         if (!c) {
             continue;
         }
-        if (c->isOnActivity(new_activity))
-            c->updateVisibility();
+        c->updateVisibility();
     }
 
     //FIXME not sure if I should do this either
@@ -1443,6 +1508,16 @@ QString Workspace::supportInformation() const
         }
         support.append(QStringLiteral("%1: %2\n").arg(property.name()).arg(printProperty(ScreenEdges::self()->property(property.name()))));
     }
+    support.append(QStringLiteral("\nWindow Management\n"));
+    support.append(QStringLiteral(  "=================\n"));
+    support.append(QStringLiteral("Managed windows: %1\n").arg(m_manageStatistics.count));
+    if (m_manageStatistics.count > 0) {
+        support.append(QStringLiteral("Average manage time: %1 usec\n").arg(m_manageStatistics.total / qint64(m_manageStatistics.count) / 1000));
+        support.append(QStringLiteral("Maximum manage time: %1 usec\n").arg(m_manageStatistics.maximum / 1000));
+    }
+    support.append(QStringLiteral("\nStartup\n"));
+    support.append(QStringLiteral(  "=======\n"));
+    support.append(StartupTrace::supportInformation());
     support.append(QStringLiteral("\nScreens\n"));
     support.append(QStringLiteral(  "=======\n"));
     support.append(QStringLiteral("Multi-Head: "));
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sm.h"
 #include "options.h"
 #include "utils.h"
+#include "xcbutils.h"
 // Qt
 #include <QTimer>
 #include <QVector>
@@ -45,15 +46,13 @@ class KStartupInfoData;
 namespace KWin
 {
 
-namespace Xcb
-{
-class Window;
-}
-
 class AbstractClient;
 class Client;
 class KillWindow;
+class LayeredStackingOrder;
 class ShortcutDialog;
+class SnapEdgeIndex;
+class StackingIndex;
 class UserActionsMenu;
 class Compositor;
 class X11EventFilter;
@@ -241,6 +240,16 @@ public:
      * at the last position
      */
     const ToplevelList& stackingOrder() const;
+    /**
+     * Returns the windows of the stacking order on virtual desktop @p desktop, including the
+     * ones on all desktops, with topmost window at the last position
+     */
+    const ToplevelList& stackingOrderOnDesktop(uint desktop) const;
+    /**
+     * Returns the windows of the stacking order on activity @p activity, with topmost window
+     * at the last position
+     */
+    const ToplevelList& stackingOrderOnActivity(const QString &activity) const;
     ToplevelList xStackingOrder() const;
     ClientList ensureStackingOrder(const ClientList& clients) const;
 
@@ -489,7 +498,12 @@ private:
 
     /// This is the right way to create a new client
     Client* createClient(xcb_window_t w, bool is_mapped);
+    /// Creates a new client from the already requested window attributes and geometry
+    Client* createClient(xcb_window_t w, bool is_mapped, Xcb::WindowAttributes &attr, Xcb::WindowGeometry &geometry);
+    Client* createClient(xcb_window_t w, std::function<bool (Client*)> manage);
     void addClient(Client* c);
+    // keeps the StackingIndex up to date with the desktop and activities of the client
+    void trackStackingIndex(AbstractClient *c);
     Unmanaged* createUnmanaged(xcb_window_t w);
     void addUnmanaged(Unmanaged* c);
 
@@ -532,6 +546,7 @@ private:
     ToplevelList stacking_order; // Topmost last
     bool force_restacking;
     mutable ToplevelList x_stacking; // From XQueryTree()
+    QVector<xcb_window_t> m_propagatedWindowStack; // Last window stack sent to X, topmost first
     mutable bool x_stacking_dirty;
     QList<AbstractClient*> should_get_focus; // Last is most recent
     QList<AbstractClient*> attention_chain;
@@ -586,6 +601,15 @@ private:
     friend class StackingUpdatesBlocker;
 
     QScopedPointer<KillWindow> m_windowKiller;
+    QScopedPointer<SnapEdgeIndex> m_snapEdgeIndex;
+    QScopedPointer<StackingIndex> m_stackingIndex;
+    QScopedPointer<LayeredStackingOrder> m_layeredStackingOrder;
+
+    struct ManageStatistics {
+        quint64 count = 0;
+        qint64 total = 0;
+        qint64 maximum = 0;
+    } m_manageStatistics;
 
     QList<X11EventFilter *> m_eventFilters;
     QList<X11EventFilter *> m_genericEventFilters;
@@ -576,6 +576,11 @@ Shm::~Shm()
     }
 }
 
+int Shm::size()
+{
+    return 4096 * 2048 * 4; // TODO check there are not larger windows
+}
+
 bool Shm::init()
 {
     const xcb_query_extension_reply_t *ext = xcb_get_extension_data(connection(), &xcb_shm_id);
@@ -590,8 +595,7 @@ bool Shm::init()
         return false;
     }
     m_pixmapFormat = version->pixmap_format;
-    const int MAXSIZE = 4096 * 2048 * 4; // TODO check there are not larger windows
-    m_shmId = shmget(IPC_PRIVATE, MAXSIZE, IPC_CREAT | 0600);
+    m_shmId = shmget(IPC_PRIVATE, size(), IPC_CREAT | 0600);
     if (m_shmId < 0) {
         qCDebug(KWIN_CORE) << "Failed to allocate SHM segment";
         return false;
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <xcb/composite.h>
 #include <xcb/randr.h>
 
+#include <xcb/shape.h>
 #include <xcb/shm.h>
 
 class TestXcbSizeHints;
@@ -552,6 +553,7 @@ private:
 
 XCB_WRAPPER(WindowAttributes, xcb_get_window_attributes, xcb_window_t)
 XCB_WRAPPER(OverlayWindow, xcb_composite_get_overlay_window, xcb_window_t)
+XCB_WRAPPER(ShapeExtents, xcb_shape_query_extents, xcb_window_t)
 
 XCB_WRAPPER_DATA(GeometryData, xcb_get_geometry, xcb_drawable_t)
 class WindowGeometry : public Wrapper<GeometryData, xcb_window_t>
@@ -1794,6 +1796,10 @@ public:
     xcb_shm_seg_t segment() const;
     bool isValid() const;
     uint8_t pixmapFormat() const;
+    /**
+     * The size of the segment in bytes.
+     **/
+    static int size();
 private:
     bool init();
     int m_shmId;